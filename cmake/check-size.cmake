@@ -0,0 +1,7 @@
+# Fails the build when FILE is larger than BUDGET bytes.
+# Usage: cmake -DFILE=<path> -DBUDGET=<bytes> -P check-size.cmake
+file(SIZE ${FILE} size)
+if (size GREATER BUDGET)
+    message(FATAL_ERROR "${FILE} is ${size} bytes, over its ${BUDGET} byte budget")
+endif()
+message(STATUS "${FILE}: ${size} of ${BUDGET} bytes")
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <eosio/crypto.hpp>
+#include <eosio/to_bin.hpp>
+#include <vector>
+
+#include "schemas.hpp"
+
+// Ballots signed off-chain. Shared by the contract, which verifies them, and by the relayers that
+// collect and sign them.
+//
+// A ballot is signed over sha256 of the binary encoding of the chain id, the contract account and the
+// ballot, so a ballot signed for one deployment of the contract is not valid for another, on the same
+// chain or on another chain where the contract runs under the same account.
+namespace eden_fractal::ballots {
+
+    inline eosio::checksum256 digest(const eosio::checksum256& chainId, eosio::name contract, const Ballot& ballot)
+    {
+        auto bin = eosio::convert_to_bin(chainId);
+        auto contractBin = eosio::convert_to_bin(contract);
+        auto ballotBin = eosio::convert_to_bin(ballot);
+        bin.insert(bin.end(), contractBin.begin(), contractBin.end());
+        bin.insert(bin.end(), ballotBin.begin(), ballotBin.end());
+        return eosio::sha256(bin.data(), bin.size());
+    }
+
+}  // namespace eden_fractal::ballots
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eden_fractal::consensus {
+
+    // Rankings are permutations of member indices 0..n-1, where index i is the i-th member in sorted name order.
+    //
+    // A ranking is summarized by its pair mask: bit k is set when the lower member of the k-th pair (i < j) is ranked
+    // above the higher one. The Kendall tau distance between two rankings, the number of pairs they order differently,
+    // is then the popcount of the XOR of their masks.
+
+    constexpr size_t factorial(size_t n)
+    {
+        return n <= 1 ? 1 : n * factorial(n - 1);
+    }
+
+    template <size_t N>
+    constexpr uint32_t pair_mask(const std::array<uint8_t, N>& ranking)
+    {
+        std::array<uint8_t, N> position{};
+        for (size_t pos = 0; pos < N; ++pos) {
+            position[ranking[pos]] = pos;
+        }
+
+        uint32_t mask = 0;
+        size_t k = 0;
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = i + 1; j < N; ++j, ++k) {
+                if (position[i] < position[j]) {
+                    mask |= uint32_t(1) << k;
+                }
+            }
+        }
+        return mask;
+    }
+
+    // Largest room whose consensus is solved exactly, by scoring all of its 720 rankings
+    constexpr size_t max_exact_size = 6;
+
+    // Every ranking of N members in lexicographic order, with its pair mask. Generated at compile time.
+    template <size_t N>
+    struct PermutationTable {
+        static_assert(N <= max_exact_size, "Larger rooms have too many rankings to score");
+
+        static constexpr size_t count = factorial(N);
+
+        std::array<std::array<uint8_t, N>, count> rankings{};
+        std::array<uint16_t, count> masks{};
+
+        constexpr PermutationTable()
+        {
+            std::array<uint8_t, N> current{};
+            for (size_t i = 0; i < N; ++i) {
+                current[i] = i;
+            }
+
+            for (size_t p = 0; p < count; ++p) {
+                rankings[p] = current;
+                masks[p] = pair_mask(current);
+
+                // Advance to the next permutation in lexicographic order
+                size_t i = N - 1;
+                while (i > 0 && current[i - 1] >= current[i]) {
+                    --i;
+                }
+                if (i == 0) {
+                    break;
+                }
+                size_t j = N - 1;
+                while (current[j] <= current[i - 1]) {
+                    --j;
+                }
+                std::swap(current[i - 1], current[j]);
+                for (size_t a = i, b = N - 1; a < b; ++a, --b) {
+                    std::swap(current[a], current[b]);
+                }
+            }
+        }
+    };
+
+    template <size_t N>
+    inline constexpr PermutationTable<N> permutations{};
+
+    struct Ballot {
+        std::vector<uint8_t> ranking;  // Member indices in submission order, the top-ranked member last
+        uint32_t weight;               // Number of members who submitted this ranking
+    };
+
+    // Scores every ranking of the room against the ballots. See solve.
+    template <size_t N>
+    std::array<uint8_t, N> solve_exact(const std::vector<Ballot>& ballots, const std::array<uint32_t, N>& borda)
+    {
+        const auto& table = permutations<N>;
+
+        std::vector<std::pair<uint32_t, uint32_t>> masks;
+        for (const auto& ballot : ballots) {
+            std::array<uint8_t, N> ranking;
+            for (size_t pos = 0; pos < N; ++pos) {
+                ranking[pos] = ballot.ranking[pos];
+            }
+            masks.emplace_back(pair_mask(ranking), ballot.weight);
+        }
+
+        size_t best = 0;
+        uint32_t bestDistance = ~uint32_t{0};
+        uint32_t bestBorda = 0;
+        for (size_t p = 0; p < table.count; ++p) {
+            uint32_t distance = 0;
+            for (const auto& [mask, weight] : masks) {
+                distance += weight * __builtin_popcount(table.masks[p] ^ mask);
+            }
+            if (distance > bestDistance) {
+                continue;
+            }
+
+            // Largest when members with higher Borda scores are ranked higher
+            uint32_t bordaScore = 0;
+            for (size_t pos = 0; pos < N; ++pos) {
+                bordaScore += borda[table.rankings[p][pos]] * pos;
+            }
+            if (distance < bestDistance || bordaScore > bestBorda) {
+                best = p;
+                bestDistance = distance;
+                bestBorda = bordaScore;
+            }
+        }
+        return table.rankings[best];
+    }
+
+    // Weighted Borda score of each member: the number of ballot places below it, summed over the ballots.
+    // Positions count from the end, so the top-ranked member of a ballot gets N - 1.
+    template <size_t N>
+    std::array<uint32_t, N> borda_scores(const std::vector<Ballot>& ballots)
+    {
+        std::array<uint32_t, N> borda{};
+        for (const auto& ballot : ballots) {
+            for (size_t pos = 0; pos < N; ++pos) {
+                borda[ballot.ranking[pos]] += ballot.weight * pos;
+            }
+        }
+        return borda;
+    }
+
+    // Kemeny consensus of the ballots: the ranking with the least total weighted Kendall tau distance to them.
+    // Ties go to the ranking closest to the Borda order, then to the lowest permutation, so the result is deterministic.
+    //
+    // Rooms larger than max_exact_size have too many rankings to score within the CPU budget of one action, so
+    // their consensus is the Borda order instead: members sorted by Borda score, ties kept in member index order.
+    template <size_t N>
+    std::array<uint8_t, N> solve(const std::vector<Ballot>& ballots)
+    {
+        auto borda = borda_scores<N>(ballots);
+        if constexpr (N > max_exact_size) {
+            std::array<uint8_t, N> order{};
+            for (size_t i = 0; i < N; ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](uint8_t a, uint8_t b) { return borda[a] < borda[b]; });
+            return order;
+        }
+        else {
+            return solve_exact<N>(ballots, borda);
+        }
+    }
+
+}  // namespace eden_fractal::consensus
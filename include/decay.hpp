@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "schemas.hpp"
+
+// Per-election decay of respect, in Q32 fixed point so every node computes the same amounts.
+// Shared by the contract and the off-chain tools in tools/.
+namespace eden_fractal::decay {
+
+    constexpr uint32_t no_decay_ppm = 1'000'000;
+    constexpr uint64_t one = uint64_t{1} << 32;
+
+    constexpr uint64_t table_size = 64;
+    constexpr uint64_t wrap_span = table_size * table_size;
+
+    // Product of two Q32 factors, rounded to nearest
+    inline uint64_t mul(uint64_t a, uint64_t b)
+    {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b + (one >> 1)) >> 32);
+    }
+
+    // `retainPpm` must be in (0, no_decay_ppm]
+    inline DecayTables make_tables(uint32_t retainPpm)
+    {
+        auto retain = ((uint64_t{retainPpm} << 32) + no_decay_ppm / 2) / no_decay_ppm;
+
+        DecayTables tables{.retainPpm = retainPpm};
+        tables.low.push_back(one);
+        for (uint64_t n = 1; n < table_size; ++n) {
+            tables.low.push_back(mul(tables.low.back(), retain));
+        }
+        auto step = mul(tables.low.back(), retain);
+        tables.high.push_back(one);
+        for (uint64_t n = 1; n < table_size; ++n) {
+            tables.high.push_back(mul(tables.high.back(), step));
+        }
+        tables.wrap = mul(tables.high.back(), step);
+        return tables;
+    }
+
+    // r^elections in Q32. Gaps of 4096 elections or more take one extra multiplication per 4096.
+    inline uint64_t power(const DecayTables& tables, uint64_t elections)
+    {
+        if (tables.retainPpm == no_decay_ppm) {
+            return one;
+        }
+        uint64_t factor = one;
+        for (; elections >= wrap_span && factor > 0; elections -= wrap_span) {
+            factor = mul(factor, tables.wrap);
+        }
+        return mul(factor, mul(tables.high[elections / table_size], tables.low[elections % table_size]));
+    }
+
+    // `amount` decayed over `elections` elections, rounded down
+    inline int64_t apply(const DecayTables& tables, int64_t amount, uint64_t elections)
+    {
+        return static_cast<int64_t>((static_cast<__int128>(amount) * power(tables, elections)) >> 32);
+    }
+
+    // `respect` decayed to election `electionNr`
+    inline int64_t decayed(const DecayTables& tables, const Respect& respect, uint64_t electionNr)
+    {
+        return electionNr > respect.lastElection ? apply(tables, respect.raw, electionNr - respect.lastElection) : respect.raw;
+    }
+
+}  // namespace eden_fractal::decay
@@ -8,6 +8,32 @@ namespace eden_fractal {
         // Consensus submission-related
         constexpr std::string_view noElections = "No eletions have happened yet.";
         constexpr std::string_view electionEnded = "Election has ended.";
+        constexpr std::string_view alreadySubmitted = "You can vote only once my friend.";
+        constexpr std::string_view wrongElection = "Submission is not for the current election.";
+        constexpr std::string_view noSigners = "At least one signer is required.";
+        constexpr std::string_view signerNotInGroup = "Every signer must be ranked in the submitted group.";
+        constexpr std::string_view duplicateSigner = "A signer is listed more than once.";
+        constexpr std::string_view noSubmissions = "No ranking of this group's members was submitted.";
+        constexpr std::string_view noRoster = "No group with this number was formed in this election.";
+        constexpr std::string_view ballotBatchTooLarge = "Too many ballots in one submission. Split them into smaller batches.";
+        constexpr std::string_view noBallotKey = "The ballot's signer has not registered a ballot key.";
+        constexpr std::string_view staleNonce = "The ballot's nonce must exceed the nonce of the signer's previous ballot.";
+        constexpr std::string_view noChainId = "The chain id that ballots are signed for has not been set.";
+        constexpr std::string_view invalidBallotSignature = "The ballot is not signed by the signer's ballot key.";
+
+        // Group formation related
+        constexpr std::string_view alreadyCheckedIn = "You already checked in to this election.";
+        constexpr std::string_view checkinRequiresSignature = "You must sign the agreement before checking in.";
+        constexpr std::string_view checkinClosed = "Check-in is closed, groups are already being formed.";
+        constexpr std::string_view checkinBeforeSeed = "Check-in opens once the seed for this election is committed.";
+        constexpr std::string_view seedAlreadyCommitted = "A seed was already committed for this election.";
+        constexpr std::string_view noSeedCommitted = "No seed has been committed for this election.";
+        constexpr std::string_view seedMismatch = "Seed does not match the committed seed hash.";
+        constexpr std::string_view cannotFormGroups = "Checked-in members cannot be split into groups of the allowed sizes.";
+        constexpr std::string_view groupsAlreadyFormed = "Groups have already been formed for this election.";
+        constexpr std::string_view groupsNotFormed = "Groups have not been formed for this election yet.";
+        constexpr std::string_view invalidPromote = "Each room must promote at least one member, and fewer than the largest group size.";
+        constexpr std::string_view tooManyRounds = "The election already has the maximum number of rounds.";
 
         // Agreement-related
         constexpr std::string_view requiresAdmin = "Action requires admin authority. Admins: Dan Singjoy, Joshua Seymour, Chuck Macdonald.";
@@ -15,16 +41,35 @@ namespace eden_fractal {
         constexpr std::string_view noAgreement = "No agreement has been added yet";
         constexpr std::string_view notSigned = "You haven't signed this agreement. Nothing to unsign";
         constexpr std::string_view missingRequiredAuth = "Missing required authority";
+        constexpr std::string_view importBatchTooLarge = "Too many signatures in one import. Split them into smaller batches.";
+        constexpr std::string_view unknownAgreementVersion = "This version of the agreement has not been published yet.";
+
+        // Migration-related
+        constexpr std::string_view unknownTable = "Table has no versioned layout to migrate to.";
 
         // Token-related
         constexpr std::string_view tokenAlreadyCreated = "Token already created";
         constexpr std::string_view untradeable = "Token currently untradeable";
+        constexpr std::string_view noTransfers = "At least one transfer is required.";
 
         // Ranking related
         constexpr std::string_view requiresEosToken = "Quantity must be denominated in EOS";
-        constexpr std::string_view too_few_groups = "Too few groups, at least two groups must be submitted.";
-        constexpr std::string_view group_too_small = "One of the groups is too small. Minimum group size = 5.";
-        constexpr std::string_view group_too_large = "One of the groups is too large. Maximum group size = 6.";
+        constexpr std::string_view too_few_groups = "Too few groups. See the configured minimum number of groups.";
+        constexpr std::string_view group_too_small = "One of the groups is too small. See the configured minimum group size.";
+        constexpr std::string_view alreadyDistributed = "Rewards were already distributed for this election.";
+        constexpr std::string_view futureElection = "Rewards can only be settled for an election that has started.";
+        constexpr std::string_view noSettlement = "No reward root was set for this election.";
+        constexpr std::string_view leafOutOfRange = "Leaf index is out of range.";
+        constexpr std::string_view tooManyLeaves = "A reward root can have at most 65536 leaves.";
+        constexpr std::string_view alreadyClaimed = "This reward was already claimed.";
+        constexpr std::string_view invalidProof = "Merkle proof does not match the reward root.";
+        constexpr std::string_view group_too_large = "One of the groups is too large. See the configured maximum group size.";
+        constexpr std::string_view eosRewardTooSmall = "Total configured EOS distribution is too small to distribute any reward to rank 1s";
+        constexpr std::string_view invalidGroupSizes = "Group sizes must satisfy 1 <= min_group_size <= max_group_size <= 7, with at least one group.";
+        constexpr std::string_view invalidCurve = "The EOS curve needs one positive weight per rank of the largest group.";
+        constexpr std::string_view fibOffsetTooLarge = "The fibonacci offset is too large for the largest group.";
+        constexpr std::string_view invalidDecay = "The retained share of respect per election must be between 1 and 1000000 parts per million.";
+        constexpr std::string_view consensusGroupSize = "Consensus can only be solved for groups of 2 to 7 members.";
 
     }  // namespace errors
 }  // namespace eden_fractal
\ No newline at end of file
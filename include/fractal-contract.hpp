@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <eosio/asset.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/name.hpp>
@@ -7,7 +8,13 @@
 #include <string>
 #include <vector>
 
+#include "ballots.hpp"
+#include "consensus.hpp"
+#include "decay.hpp"
 #include "errors.hpp"
+#include "heap_stats.hpp"
+#include "profiler.hpp"
+#include "rewards.hpp"
 #include "schemas.hpp"
 
 using namespace eosio;
@@ -20,11 +27,22 @@ namespace eden_fractal {
     extern const char* ricardian_clause;
 
     extern const char* submitcons_ricardian;
+    extern const char* submitgroup_ricardian;
+    extern const char* setballotkey_ricardian;
+    extern const char* setchainid_ricardian;
+    extern const char* submitballots_ricardian;
     extern const char* startelect_ricardian;
 
+    extern const char* checkin_ricardian;
+    extern const char* commitseed_ricardian;
+    extern const char* formgroups_ricardian;
+    extern const char* advanceround_ricardian;
+
     extern const char* setagreement_ricardian;
     extern const char* sign_ricardian;
     extern const char* unsign_ricardian;
+    extern const char* importsigs_ricardian;
+    extern const char* purgesigs_ricardian;
 
     extern const char* create_ricardian;
     extern const char* issue_ricardian;
@@ -32,10 +50,26 @@ namespace eden_fractal {
     extern const char* transfer_ricardian;
     extern const char* open_ricardian;
     extern const char* close_ricardian;
+    extern const char* transfermany_ricardian;
+    extern const char* openmany_ricardian;
 
     extern const char* eosrewardamt_ricardian;
     extern const char* fiboffset_ricardian;
+    extern const char* setrewardcfg_ricardian;
+    extern const char* setdecay_ricardian;
     extern const char* submitranks_ricardian;
+    extern const char* distribcons_ricardian;
+    extern const char* logdistrib_ricardian;
+    extern const char* membernotifs_ricardian;
+    extern const char* setroot_ricardian;
+    extern const char* claimproof_ricardian;
+    extern const char* respectof_ricardian;
+    extern const char* powerof_ricardian;
+    extern const char* consensusof_ricardian;
+    extern const char* getstats_ricardian;
+    extern const char* exportstate_ricardian;
+    extern const char* balanceat_ricardian;
+    extern const char* migrate_ricardian;
 
     // The account at which this contract is deployed
     inline constexpr auto default_contract_account = "eden.fractal"_n;
@@ -44,30 +78,95 @@ namespace eden_fractal {
     constexpr symbol eos_symbol{"EOS", 4};
     constexpr symbol eden_symbol{eden_ticker, 4};
 
+    // Records returned by one exportstate call at most
+    constexpr uint32_t max_export_page = 500;
+
+    // Reward leaves of one setroot at most. Its claimed-bitmap is then at most 8KB of contract RAM.
+    constexpr uint32_t max_settlement_leaves = 65536;
+
+    // Rounds of an election are numbered 0 (the groups of formgroups) to max_round
+    constexpr uint64_t max_round = 255;
+
+    // Group `n` (1-based) of round `round`. Round 0 keeps the plain group numbers of formgroups.
+    constexpr uint64_t round_group(uint64_t round, uint64_t n)
+    {
+        return (round << 32) | n;
+    }
+    constexpr uint64_t round_of(uint64_t groupnr)
+    {
+        return groupnr >> 32;
+    }
+    // Scope of the submissions to a group. Every round after the first has its own scope, so promoted members
+    // can submit again; round 0 keeps the election number, which is all distribcons reads.
+    constexpr uint64_t submission_scope(uint64_t electionNr, uint64_t groupnr)
+    {
+        return round_of(groupnr) == 0 ? electionNr : electionNr | (round_of(groupnr) << 56);
+    }
+
     class fractal_contract : public contract {
        public:
         using eosio::contract::contract;
 
         using AgreementSingleton = eosio::singleton<"agreement"_n, Agreement>;
-        using SignersTable = eosio::multi_index<"signatures"_n, Signature>;
+        using SignersTable = eosio::multi_index<"sigs"_n, SignatureRow>;
+        using LegacySignersTable = eosio::multi_index<"signatures"_n, SignatureV0>;
         using accounts = eosio::multi_index<"accounts"_n, account>;
         using stats = eosio::multi_index<"stat"_n, currency_stats>;
-        using RewardConfigSingleton = eosio::singleton<"rewardconf"_n, RewardConfig>;
+        using RewardConfigSingleton = eosio::singleton<"rewardcfg"_n, RewardConfigRow>;
+        using LegacyRewardConfigSingleton = eosio::singleton<"rewardconf"_n, RewardConfigV0>;
+        using RewardTablesSingleton = eosio::singleton<"rewardtables"_n, RewardTables>;
+        using DecayTablesSingleton = eosio::singleton<"decaytables"_n, DecayTables>;
+        using RespectTable = eosio::multi_index<"respect"_n, Respect>;
+        using MigrationsTable = eosio::multi_index<"migrations"_n, MigrationCursor>;
+        using DistribConfigSingleton = eosio::singleton<"distconf"_n, DistribConfig>;
+        using HoldersTable = eosio::multi_index<"holders"_n, Holder>;
+        using CheckpointsTable = eosio::multi_index<"checkpoints"_n, BalanceCheckpoint>;
 
         using ConsenzusTable = eosio::multi_index<"consenzus"_n, Consenzus, indexed_by<"bygroupnr"_n, const_mem_fun<Consenzus, uint64_t, &Consenzus::get_secondary_1>>>;
+        using GroupConsensusTable =
+            eosio::multi_index<"groupcons"_n, GroupConsensus, indexed_by<"bygroupnr"_n, const_mem_fun<GroupConsensus, uint64_t, &GroupConsensus::get_secondary_1>>>;
+        using CoSignersTable = eosio::multi_index<"cosigners"_n, CoSigner>;
+        using BallotKeysTable = eosio::multi_index<"ballotkeys"_n, BallotKey>;
+        using BallotConfigSingleton = eosio::singleton<"ballotcfg"_n, BallotConfig>;
+
+        using ResultsTable = eosio::multi_index<"results"_n, ElectionResults>;
+        using SettlementsTable = eosio::multi_index<"settlements"_n, Settlement>;
+        using MembersTable = eosio::multi_index<"members"_n, MemberId, indexed_by<"bymember"_n, const_mem_fun<MemberId, uint64_t, &MemberId::get_secondary_1>>>;
 
         using ElectionCountSingleton = eosio::singleton<"electioninf"_n, ElectionInf>;
 
+        using CheckinTable = eosio::multi_index<"checkins"_n, CheckIn, indexed_by<"byshuffle"_n, const_mem_fun<CheckIn, uint64_t, &CheckIn::get_secondary_1>>>;
+        using RosterTable = eosio::multi_index<"rosters"_n, Roster>;
+        using GroupFormationSingleton = eosio::singleton<"groupform"_n, GroupFormation>;
+        using ElectionRoundSingleton = eosio::singleton<"electround"_n, ElectionRound>;
+        using PromotionsTable = eosio::multi_index<"promotions"_n, Promotion>;
+
+        using GlobalStatsSingleton = eosio::singleton<"globalstats"_n, GlobalStats>;
+        using ElectionStatsTable = eosio::multi_index<"electstats"_n, ElectionStats>;
+        using AttendanceTable = eosio::multi_index<"attendance"_n, Attendance>;
+
         fractal_contract(name receiver, name code, datastream<const char*> ds);
 
         // Consensus sumbission-related actions
         void startelect();
         void submitcons(const uint64_t& groupnr, const std::vector<name>& rankings, const name& submitter);
+        void submitgroup(const uint64_t& electionNr, const uint64_t& groupnr, const std::vector<name>& rankings, const std::vector<name>& signers);
+        void setballotkey(const name& member, const public_key& key);
+        void setchainid(const checksum256& chain_id);
+        void submitballots(const name& relayer, const std::vector<SignedBallot>& ballots);
+
+        // Group formation related actions
+        void checkin(const name& member);
+        void commitseed(const checksum256& seedhash);
+        void formgroups(const checksum256& seed, uint32_t max_steps);
+        void advanceround(uint8_t promote, uint32_t max_steps);
 
         // Agreement-related actions
         void setagreement(const std::string& agreement);
         void sign(const name& signer);
         void unsign(const name& signer);
+        void importsigs(const std::vector<name>& signers, uint8_t version);
+        void purgesigs(uint32_t max_rows);
 
         // Token-related actions
         void create();
@@ -76,11 +175,33 @@ namespace eden_fractal {
         void transfer(const name& from, const name& to, const asset& quantity, const string& memo);
         void open(const name& owner, const symbol& symbol, const name& ram_payer);
         void close(const name& owner, const symbol& symbol);
+        void transfermany(const name& from, const std::vector<TokenTransfer>& transfers, const string& memo, bool notify_recipients);
+        void openmany(const std::vector<name>& owners, const name& ram_payer);
 
         // Ranking-related actions (may only be called by admins)
         void eosrewardamt(const asset& quantity);
         void fiboffset(uint8_t offset);
+        void setrewardcfg(uint8_t min_groups, uint8_t min_group_size, uint8_t max_group_size, const std::vector<double>& eos_curve);
+        void setdecay(uint32_t retain_ppm);
         void submitranks(const AllRankings& ranks);
+        void distribcons();
+        void logdistrib(uint64_t electionNr, const std::vector<DistributionRecord>& records);
+        void membernotifs(bool enabled);
+
+        // Merkle-root settlement (alternative to submitranks)
+        void setroot(uint64_t electionNr, const checksum256& root, uint32_t num_leaves, const asset& eden_total, const asset& eos_total);
+        void claimproof(uint64_t electionNr, const RewardLeaf& leaf, const std::vector<checksum256>& proof);
+
+        // Schema migration
+        void migrate(const name& table, uint32_t max_rows);
+
+        // Read-only queries
+        RespectSummary respectof(const name& member, uint64_t from_election, uint64_t to_election);
+        asset powerof(const name& member);
+        std::vector<name> consensusof(uint64_t groupnr);
+        StatsSummary getstats();
+        StateExport exportstate(const name& cursor, uint32_t limit);
+        asset balanceat(const name& owner, uint64_t electionNr);
 
         // Tester/contract interface to simplify token queries
         static asset get_supply(const symbol_code& sym_code)
@@ -95,8 +216,258 @@ namespace eden_fractal {
             const auto& ac = accountstable.get(sym_code.raw());
             return ac.balance;
         }
+        // EDEN balance of `owner` as of the end of election `electionNr`. An account without checkpoints has not
+        // changed balance since checkpoints were introduced, so its current balance applies. The contract's own
+        // account is never checkpointed.
+        static asset get_balance_at(const name& owner, uint64_t electionNr)
+        {
+            CheckpointsTable checkpoints(default_contract_account, owner.value);
+            if (checkpoints.begin() == checkpoints.end()) {
+                accounts accountstable(default_contract_account, owner.value);
+                auto it = accountstable.find(eden_symbol.code().raw());
+                return it != accountstable.end() ? it->balance : asset{0, eden_symbol};
+            }
+
+            // The latest checkpoint at or before electionNr, or the earliest known balance for elections before it
+            auto it = checkpoints.upper_bound(electionNr);
+            if (it != checkpoints.begin()) {
+                --it;
+            }
+            return asset{it->balance, eden_symbol};
+        }
+        // Sums the rewards of `member` over the archived elections from_election..to_election (inclusive)
+        static RespectSummary get_respect(const name& member, uint64_t from_election, uint64_t to_election)
+        {
+            auto summary = RespectSummary{asset{0, eden_symbol}, asset{0, eos_symbol}, 0};
+
+            MembersTable members(default_contract_account, default_contract_account.value);
+            auto byMember = members.get_index<"bymember"_n>();
+            auto m = byMember.find(member.value);
+            if (m == byMember.end()) {
+                return summary;
+            }
+            auto id = static_cast<uint32_t>(m->id);
+
+            ResultsTable results(default_contract_account, default_contract_account.value);
+            for (auto it = results.lower_bound(from_election); it != results.end() && it->electionNr <= to_election; ++it) {
+                auto pos = std::lower_bound(it->memberIds.begin(), it->memberIds.end(), id);
+                if (pos == it->memberIds.end() || *pos != id) {
+                    continue;
+                }
+                auto rankIndex = it->rank_index(pos - it->memberIds.begin());
+                summary.eden.amount += it->edenByRank[rankIndex];
+                summary.eos.amount += it->eosByRank[rankIndex];
+                ++summary.elections;
+            }
+            return summary;
+        }
+
+        // Computed on the fly until setdecay is first called, which means no decay
+        static DecayTables get_decay_tables()
+        {
+            DecayTablesSingleton tables(default_contract_account, default_contract_account.value);
+            return tables.exists() ? tables.get() : decay::make_tables(decay::no_decay_ppm);
+        }
+        // Respect of `member` decayed to election `electionNr`: one row read, however long ago it was last credited
+        static asset get_decayed_respect(const name& member, uint64_t electionNr)
+        {
+            RespectTable respect(default_contract_account, default_contract_account.value);
+            auto it = respect.find(member.value);
+            if (it == respect.end()) {
+                return asset{0, eden_symbol};
+            }
+            return asset{decay::decayed(get_decay_tables(), *it, electionNr), eden_symbol};
+        }
+
+        // One page of the EDEN holders in account name order, starting at `cursor`, with their balances and signatures
+        static StateExport get_state_export(const name& cursor, uint32_t limit)
+        {
+            StateExport page;
+            HoldersTable holders(default_contract_account, default_contract_account.value);
+            SignersTable signers(default_contract_account, default_contract_account.value);
+            LegacySignersTable legacySigners(default_contract_account, default_contract_account.value);
+
+            auto it = holders.lower_bound(cursor.value);
+            for (; it != holders.end() && page.records.size() < std::min(limit, max_export_page); ++it) {
+                auto& record = page.records.emplace_back(HolderState{.owner = it->owner});
+                accounts balances(default_contract_account, it->owner.value);
+                record.balance = balances.get(eden_symbol.code().raw()).balance.amount;
+
+                auto sig = signers.find(it->owner.value);
+                if (sig != signers.end()) {
+                    record.signedVersion = latest(sig->value).agreementVersion;
+                }
+                else if (legacySigners.find(it->owner.value) != legacySigners.end()) {
+                    record.signedVersion = 0;  // Legacy signatures predate agreement versions, like SignatureV0
+                }
+            }
+            if (it != holders.end()) {
+                page.next = it->owner;
+            }
+            return page;
+        }
+
+        // Round state of the current election. Elections without advanceround calls are in round 0.
+        static ElectionRound get_election_round()
+        {
+            ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+            auto electionNr = electionSingleton.exists() ? electionSingleton.get().electionNr : 0;
+
+            ElectionRoundSingleton roundSingleton(default_contract_account, default_contract_account.value);
+            auto round = roundSingleton.get_or_default(ElectionRound{});
+            return round.electionNr == electionNr ? round : ElectionRound{.electionNr = electionNr};
+        }
+
+        static Attendance get_attendance(const name& member)
+        {
+            AttendanceTable table(default_contract_account, default_contract_account.value);
+            auto it = table.find(member.value);
+            return it != table.end() ? *it : Attendance{.member = member};
+        }
+
+        static StatsSummary get_stats()
+        {
+            ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+            auto electionNr = electionSingleton.exists() ? electionSingleton.get().electionNr : 0;
+
+            // Signers are counted here rather than by sign and unsign, so signing doesn't write a row every signer shares
+            SignersTable signers(default_contract_account, default_contract_account.value);
+            LegacySignersTable legacy(default_contract_account, default_contract_account.value);
+            auto numSigners = std::distance(signers.begin(), signers.end()) + std::distance(legacy.begin(), legacy.end());
+
+            // Submissions likewise, over the scopes of every round of the current election
+            uint32_t submissions = 0;
+            std::vector<uint64_t> groups;
+            for (uint64_t round = 0; electionNr > 0 && round <= max_round; ++round) {
+                auto scope = submission_scope(electionNr, round_group(round, 1));
+                ConsenzusTable individual(default_contract_account, scope);
+                for (const auto& row : individual) {
+                    ++submissions;
+                    groups.push_back(row.groupNr);
+                }
+                CoSignersTable cosigners(default_contract_account, scope);
+                submissions += std::distance(cosigners.begin(), cosigners.end());
+                GroupConsensusTable cosigned(default_contract_account, scope);
+                for (const auto& row : cosigned) {
+                    groups.push_back(row.groupNr);
+                }
+            }
+            std::sort(groups.begin(), groups.end());
+            auto groupsReported = std::unique(groups.begin(), groups.end()) - groups.begin();
+
+            GlobalStatsSingleton global(default_contract_account, default_contract_account.value);
+            ElectionStatsTable elections(default_contract_account, default_contract_account.value);
+            auto it = elections.find(electionNr);
+
+            return StatsSummary{.signers = static_cast<uint64_t>(numSigners),
+                                .submissions = submissions,
+                                .groupsReported = static_cast<uint32_t>(groupsReported),
+                                .global = global.get_or_default(GlobalStats{}),
+                                .election = it != elections.end() ? *it : ElectionStats{.electionNr = electionNr}};
+        }
+
+        // Consensus ranking of a formed group, solved from all of its submitcons and submitgroup rankings (see consensus.hpp).
+        // A co-signed ranking counts once per signer. Rankings that don't rank exactly the members of the group's roster are
+        // ignored, so a stray submission can neither add accounts to a room nor block its consensus.
+        static std::vector<name> get_group_consensus(uint64_t electionNr, uint64_t groupnr)
+        {
+            RosterTable rosters(default_contract_account, electionNr);
+            auto roster = rosters.find(groupnr);
+            check(roster != rosters.end(), errors::noRoster.data());
+
+            auto ranking = get_room_consensus(electionNr, *roster);
+            check(!ranking.empty(), errors::noSubmissions.data());
+            return ranking;
+        }
+
+        // Consensus ranking of `roster`, or an empty ranking when none of its submissions rank its members
+        static std::vector<name> get_room_consensus(uint64_t electionNr, const Roster& roster)
+        {
+            auto members = roster.members;
+            std::sort(members.begin(), members.end());
+
+            std::vector<consensus::Ballot> ballots;
+            auto addBallot = [&](const std::vector<name>& rankings, uint32_t weight) {
+                if (rankings.size() != members.size()) {
+                    return;
+                }
+                consensus::Ballot ballot{.weight = weight};
+                for (auto member : rankings) {
+                    auto pos = std::lower_bound(members.begin(), members.end(), member);
+                    if (pos == members.end() || *pos != member) {
+                        return;
+                    }
+                    ballot.ranking.push_back(pos - members.begin());
+                }
+                ballots.push_back(std::move(ballot));
+            };
+
+            auto scope = submission_scope(electionNr, roster.groupNr);
+            ConsenzusTable individual(default_contract_account, scope);
+            auto byGroup = individual.get_index<"bygroupnr"_n>();
+            for (auto it = byGroup.lower_bound(roster.groupNr); it != byGroup.end() && it->groupNr == roster.groupNr; ++it) {
+                addBallot(it->rankings, 1);
+            }
+            GroupConsensusTable cosigned(default_contract_account, scope);
+            auto byGroupCosigned = cosigned.get_index<"bygroupnr"_n>();
+            for (auto it = byGroupCosigned.lower_bound(roster.groupNr); it != byGroupCosigned.end() && it->groupNr == roster.groupNr; ++it) {
+                addBallot(it->rankings, __builtin_popcount(it->signerMask));
+            }
+
+            std::vector<name> ranking;
+            if (ballots.empty()) {
+                return ranking;
+            }
+            auto appendMembers = [&](const auto& order) {
+                for (auto index : order) {
+                    ranking.push_back(members[index]);
+                }
+            };
+            switch (members.size()) {
+                case 2:
+                    appendMembers(consensus::solve<2>(ballots));
+                    break;
+                case 3:
+                    appendMembers(consensus::solve<3>(ballots));
+                    break;
+                case 4:
+                    appendMembers(consensus::solve<4>(ballots));
+                    break;
+                case 5:
+                    appendMembers(consensus::solve<5>(ballots));
+                    break;
+                case 6:
+                    appendMembers(consensus::solve<6>(ballots));
+                    break;
+                case 7:
+                    appendMembers(consensus::solve<7>(ballots));
+                    break;
+                default:
+                    check(false, errors::consensusGroupSize.data());
+            }
+            return ranking;
+        }
 
        private:
+        void distribute(const AllRankings& ranks);
+        void validate_ranking(const std::vector<name>& rankings);
+        void record_submission(uint64_t electionNr, uint64_t groupnr, const std::vector<name>& rankings, const name& submitter, const name& ram_payer);
+
+        void archive_results(uint64_t electionNr,
+                             const std::vector<std::pair<name, uint8_t>>& ranked,
+                             const std::vector<int64_t>& edenRewards,
+                             const std::vector<int64_t>& eosRewards);
+        uint32_t member_id(const name& member);
+        void mark_attendance(const name& member, uint64_t electionNr, const name& ram_payer);
+
+        bool has_signed(const name& signer);
+        void migrate_signatures(uint32_t max_rows);
+        void index_holders(uint32_t max_rows);
+
+        RewardConfig get_reward_config();
+        void set_reward_config(const RewardConfig& config);
+        RewardTables get_reward_tables();
+
         void sub_balance(const name& owner, const asset& value);
         void add_balance(const name& owner, const asset& value, const name& ram_payer);
 
@@ -105,6 +476,13 @@ namespace eden_fractal {
         void validate_symbol(const symbol& symbol);
 
         void require_admin_auth();
+
+#ifdef EDEN_FRACTAL_HEAP_STATS
+        heap_stats::ActionProbe heapProbe;
+#endif
+#ifdef EDEN_FRACTAL_PROFILE
+        profiler::ActionProfile profile;
+#endif
     };
 
     // clang-format off
@@ -113,11 +491,22 @@ namespace eden_fractal {
 
                   action(startelect, ricardian_contract(startelect_ricardian)),
                   action(submitcons, groupnr, rankings, submitter, ricardian_contract(submitcons_ricardian)),
+                  action(submitgroup, electionNr, groupnr, rankings, signers, ricardian_contract(submitgroup_ricardian)),
+                  action(setballotkey, member, key, ricardian_contract(setballotkey_ricardian)),
+                  action(setchainid, chain_id, ricardian_contract(setchainid_ricardian)),
+                  action(submitballots, relayer, ballots, ricardian_contract(submitballots_ricardian)),
+
+                  action(checkin, member, ricardian_contract(checkin_ricardian)),
+                  action(commitseed, seedhash, ricardian_contract(commitseed_ricardian)),
+                  action(formgroups, seed, max_steps, ricardian_contract(formgroups_ricardian)),
+                  action(advanceround, promote, max_steps, ricardian_contract(advanceround_ricardian)),
 
 
                   action(setagreement, ricardian_contract(setagreement_ricardian)),
                   action(sign, signer, ricardian_contract(sign_ricardian)),
                   action(unsign, signer, ricardian_contract(unsign_ricardian)),
+                  action(importsigs, signers, version, ricardian_contract(importsigs_ricardian)),
+                  action(purgesigs, max_rows, ricardian_contract(purgesigs_ricardian)),
 
                   action(create, ricardian_contract(create_ricardian)),
                   action(issue, to, quantity, memo, ricardian_contract(issue_ricardian)),
@@ -125,10 +514,28 @@ namespace eden_fractal {
                   action(transfer, from, to, quantity, memo, ricardian_contract(transfer_ricardian)),
                   action(open, owner, symbol, ram_payer, ricardian_contract(open_ricardian)),
                   action(close, owner, symbol, ricardian_contract(close_ricardian)),
+                  action(transfermany, from, transfers, memo, notify_recipients, ricardian_contract(transfermany_ricardian)),
+                  action(openmany, owners, ram_payer, ricardian_contract(openmany_ricardian)),
 
                   action(eosrewardamt, quantity, ricardian_contract(eosrewardamt_ricardian)),
                   action(fiboffset, offset, ricardian_contract(fiboffset_ricardian)),
-                  action(submitranks, ranks, ricardian_contract(submitranks_ricardian))
+                  action(setrewardcfg, min_groups, min_group_size, max_group_size, eos_curve, ricardian_contract(setrewardcfg_ricardian)),
+                  action(setdecay, retain_ppm, ricardian_contract(setdecay_ricardian)),
+                  action(submitranks, ranks, ricardian_contract(submitranks_ricardian)),
+                  action(distribcons, ricardian_contract(distribcons_ricardian)),
+                  action(logdistrib, electionNr, records, ricardian_contract(logdistrib_ricardian)),
+                  action(membernotifs, enabled, ricardian_contract(membernotifs_ricardian)),
+                  action(setroot, electionNr, root, num_leaves, eden_total, eos_total, ricardian_contract(setroot_ricardian)),
+                  action(claimproof, electionNr, leaf, proof, ricardian_contract(claimproof_ricardian)),
+
+                  action(migrate, table, max_rows, ricardian_contract(migrate_ricardian)),
+
+                  action(respectof, member, from_election, to_election, ricardian_contract(respectof_ricardian)),
+                  action(powerof, member, ricardian_contract(powerof_ricardian)),
+                  action(consensusof, groupnr, ricardian_contract(consensusof_ricardian)),
+                  action(getstats, ricardian_contract(getstats_ricardian)),
+                  action(exportstate, cursor, limit, ricardian_contract(exportstate_ricardian)),
+                  action(balanceat, owner, electionNr, ricardian_contract(balanceat_ricardian))
                   
     )
     // clang-format on
@@ -0,0 +1,33 @@
+#pragma once
+
+#ifdef EDEN_FRACTAL_HEAP_STATS
+
+#include <cstdint>
+#include <eosio/print.hpp>
+
+namespace eden_fractal::heap_stats {
+
+    // Updated by the global operator new and delete in fractal-contract.cpp. Every action runs in a fresh
+    // instance, so the counters cover exactly one action, including the decoding of its arguments.
+    struct Counters {
+        uint32_t allocations;
+        uint64_t allocatedBytes;
+        uint64_t liveBytes;
+        uint64_t peakLiveBytes;
+    };
+    extern Counters counters;
+
+    // Member of the contract object. Prints the counters to the action console once the action is done:
+    //   heap allocs=<count> bytes=<allocated> peak=<peak live bytes> pages=<64 KiB pages of linear memory>
+    // With simple-malloc nothing is ever freed, so `bytes` is what the action really takes from the heap.
+    struct ActionProbe {
+        ~ActionProbe()
+        {
+            eosio::print("heap allocs=", counters.allocations, " bytes=", counters.allocatedBytes, " peak=", counters.peakLiveBytes,
+                         " pages=", static_cast<uint32_t>(__builtin_wasm_memory_size(0)), "\n");
+        }
+    };
+
+}  // namespace eden_fractal::heap_stats
+
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstring>
+#include <eosio/crypto.hpp>
+#include <eosio/to_bin.hpp>
+#include <vector>
+
+#include "schemas.hpp"
+
+// Merkle tree over the reward leaves of a settlement. Shared by the contract, which verifies
+// claims, and by the tools that build the tree off-chain.
+//
+// Leaves are hashed as sha256 of their binary encoding. A parent is sha256(left || right).
+// A node without a sibling (the last node of a level with an odd width) moves up to the next
+// level unchanged, so a proof has no entry for that level.
+namespace eden_fractal::merkle {
+
+    inline eosio::checksum256 leaf_hash(const RewardLeaf& leaf)
+    {
+        auto bin = eosio::convert_to_bin(leaf);
+        return eosio::sha256(bin.data(), bin.size());
+    }
+
+    inline eosio::checksum256 node_hash(const eosio::checksum256& left, const eosio::checksum256& right)
+    {
+        auto l = left.extract_as_byte_array();
+        auto r = right.extract_as_byte_array();
+
+        char buffer[64];
+        std::memcpy(buffer, l.data(), 32);
+        std::memcpy(buffer + 32, r.data(), 32);
+        return eosio::sha256(buffer, sizeof(buffer));
+    }
+
+    inline std::vector<eosio::checksum256> next_level(const std::vector<eosio::checksum256>& level)
+    {
+        std::vector<eosio::checksum256> parents;
+        parents.reserve((level.size() + 1) / 2);
+        for (size_t i = 0; i < level.size(); i += 2) {
+            parents.push_back((i + 1 < level.size()) ? node_hash(level[i], level[i + 1]) : level[i]);
+        }
+        return parents;
+    }
+
+    inline eosio::checksum256 root(std::vector<eosio::checksum256> level)
+    {
+        while (level.size() > 1) {
+            level = next_level(level);
+        }
+        return level.empty() ? eosio::checksum256{} : level.front();
+    }
+
+    inline std::vector<eosio::checksum256> proof(std::vector<eosio::checksum256> level, uint32_t index)
+    {
+        std::vector<eosio::checksum256> siblings;
+        while (level.size() > 1) {
+            auto sibling = index ^ 1;
+            if (sibling < level.size()) {
+                siblings.push_back(level[sibling]);
+            }
+            level = next_level(level);
+            index /= 2;
+        }
+        return siblings;
+    }
+
+    inline bool verify(const eosio::checksum256& root, uint32_t numLeaves, const RewardLeaf& leaf, const std::vector<eosio::checksum256>& proof)
+    {
+        auto node = leaf_hash(leaf);
+        uint64_t index = leaf.index;
+        uint64_t width = numLeaves;
+        size_t used = 0;
+
+        while (width > 1) {
+            if (index % 2 == 1 || index + 1 < width) {
+                if (used == proof.size()) {
+                    return false;
+                }
+                const auto& sibling = proof[used++];
+                node = (index % 2 == 1) ? node_hash(sibling, node) : node_hash(node, sibling);
+            }
+            index /= 2;
+            width = (width + 1) / 2;
+        }
+        return used == proof.size() && node == root;
+    }
+
+}  // namespace eden_fractal::merkle
@@ -0,0 +1,36 @@
+#pragma once
+
+#ifdef EDEN_FRACTAL_PROFILE
+
+#include <cstdint>
+
+// Function-level profiler for the debug contract, built with -finstrument-functions and
+// -fsanitize-coverage=trace-pc.
+//
+// Contracts can't read a clock, so the profiler keeps its own: every basic-block edge the contract executes
+// advances it by one tick. The entry and exit hooks timestamp each call with that clock, and at the end of each
+// action every call stack is printed to the action console as one
+//   "profile <fn>;<fn>;... <calls> <inclusive ticks> <exclusive ticks>"
+// line, where <fn> is the function's index in the wasm table. Ticks cover the contract's own code; the time spent
+// inside host functions such as the database intrinsics counts as a single tick. tools/profile/symbolize.sh maps the
+// indices to names, after which the output can be fed to flamegraph.pl.
+//
+// The hooks live in src/profiler.cpp, which is compiled without the instrumentation so that recording doesn't
+// advance the clock or call itself.
+namespace eden_fractal::profiler {
+
+    // Starts recording for the current action
+    void start();
+
+    // Stops recording and prints the profile of the action
+    void finish();
+
+    // Member of the contract object: records the action and prints the profile once it is done
+    struct ActionProfile {
+        __attribute__((no_instrument_function)) ActionProfile() { start(); }
+        __attribute__((no_instrument_function)) ~ActionProfile() { finish(); }
+    };
+
+}  // namespace eden_fractal::profiler
+
+#endif
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "errors.hpp"
+#include "schemas.hpp"
+
+// Reward amounts of a distribution. Shared by the contract and the off-chain reward simulator in tools/,
+// so both compute bit-identical amounts.
+namespace eden_fractal::rewards {
+
+    // Largest room the consensus solver handles (7! rankings). Also bounds the co-signer bits of GroupConsensus
+    // and the 4-bit rank indices of ElectionResults.
+    constexpr uint8_t max_group_size = 7;
+    static_assert(max_group_size <= 8 * sizeof(GroupConsensus::signerMask));
+
+    // Largest fibonacci index whose EDEN amount still fits in an int64_t at 4 decimals
+    constexpr uint32_t max_fib_index = 73;
+
+    inline int64_t fib(uint32_t index)
+    {
+        int64_t current = 0, next = 1;
+        for (; index > 0; --index) {
+            next += current;
+            current = next - current;
+        }
+        return current;
+    }
+
+    inline int64_t pow10(uint8_t exponent)
+    {
+        int64_t result = 1;
+        for (; exponent > 0; --exponent) {
+            result *= 10;
+        }
+        return result;
+    }
+
+    // The reason `config` can't be set, or an empty string when it is valid
+    inline std::string_view config_error(const RewardConfig& config)
+    {
+        if (config.min_groups < 1 || config.min_group_size < 1 || config.min_group_size > config.max_group_size || config.max_group_size > max_group_size) {
+            return errors::invalidGroupSizes;
+        }
+        if (config.eos_curve.size() != config.max_group_size
+            || !std::all_of(config.eos_curve.begin(), config.eos_curve.end(), [](auto weight) { return weight > 0; })) {
+            return errors::invalidCurve;
+        }
+        if (config.fib_offset + config.max_group_size - 1 > max_fib_index) {
+            return errors::fibOffsetTooLarge;
+        }
+        return {};
+    }
+
+    // EDEN amounts use `precision` decimals. The config must be valid, see config_error.
+    inline RewardTables make_tables(const RewardConfig& config, uint8_t precision)
+    {
+        RewardTables tables{.min_groups = config.min_groups,
+                            .min_group_size = config.min_group_size,
+                            .max_group_size = config.max_group_size,
+                            .eosWeights = config.eos_curve,
+                            .eosWeightSum = 0,
+                            .eosRewardAmt = config.eos_reward_amt};
+        for (size_t rankIndex = 0; rankIndex < config.max_group_size; ++rankIndex) {
+            tables.edenByRank.push_back(fib(rankIndex + config.fib_offset) * pow10(precision));
+        }
+        for (auto weight : config.eos_curve) {
+            tables.eosWeightSum += weight;
+        }
+        return tables;
+    }
+
+    // Rank index of the member at 0-based `position` in a group of `groupSize`
+    inline size_t rank_index(const RewardTables& tables, size_t groupSize, size_t position)
+    {
+        return tables.max_group_size - groupSize + position;
+    }
+
+    // EOS per rank index when `numGroups` groups share the configured amount. Amounts are rounded down.
+    inline std::vector<int64_t> eos_by_rank(const RewardTables& tables, size_t numGroups)
+    {
+        auto multiplier = (double)tables.eosRewardAmt / (numGroups * tables.eosWeightSum);
+
+        std::vector<int64_t> amounts;
+        for (auto weight : tables.eosWeights) {
+            amounts.push_back(static_cast<int64_t>(multiplier * weight));
+        }
+        return amounts;
+    }
+
+    struct Distribution {
+        std::vector<DistributionRecord> records;  // One per ranked member, in the order of the rankings
+        std::vector<int64_t> eosByRank;           // See eos_by_rank
+        int64_t edenTotal = 0;
+    };
+
+    // The rewards of a submitranks call, after the checks it makes that don't need the chain. Fails with the error
+    // message of submitranks in `error` and an empty distribution.
+    inline Distribution distribution(const AllRankings& ranks, const RewardTables& tables, std::string& error)
+    {
+        auto numGroups = ranks.allRankings.size();
+        if (numGroups < tables.min_groups) {
+            error = errors::too_few_groups;
+            return {};
+        }
+
+        Distribution result{.eosByRank = eos_by_rank(tables, numGroups)};
+        if (std::any_of(result.eosByRank.begin(), result.eosByRank.end(), [](auto amount) { return amount <= 0; })) {
+            error = errors::eosRewardTooSmall;
+            return {};
+        }
+
+        std::vector<eosio::name> listed;
+        for (const auto& rank : ranks.allRankings) {
+            auto groupSize = rank.ranking.size();
+            if (groupSize < tables.min_group_size || groupSize > tables.max_group_size) {
+                error = groupSize < tables.min_group_size ? errors::group_too_small : errors::group_too_large;
+                return {};
+            }
+            for (size_t position = 0; position < groupSize; ++position) {
+                auto rankIndex = rank_index(tables, groupSize, position);
+                result.records.push_back(DistributionRecord{.member = rank.ranking[position],
+                                                            .rank = static_cast<uint8_t>(rankIndex),
+                                                            .eden = tables.edenByRank[rankIndex],
+                                                            .eos = result.eosByRank[rankIndex]});
+                result.edenTotal += tables.edenByRank[rankIndex];
+                listed.push_back(rank.ranking[position]);
+            }
+        }
+
+        std::sort(listed.begin(), listed.end());
+        auto duplicate = std::adjacent_find(listed.begin(), listed.end());
+        if (duplicate != listed.end()) {
+            error = "account " + duplicate->to_string() + " listed more than once";
+            return {};
+        }
+        return result;
+    }
+
+}  // namespace eden_fractal::rewards
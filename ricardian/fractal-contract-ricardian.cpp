@@ -8,9 +8,38 @@ const char* eden_fractal::submitcons_ricardian = R"(
 This action enables participants of election to submit rankings of their group members.
 )";
 
+const char* eden_fractal::submitgroup_ricardian = R"(
+This action enables several members of a group to submit the same ranking of their group in one transaction. Every signer must authorize the action, be ranked in the group, and not have voted in any room of the round yet.
+)";
+
+const char* eden_fractal::setballotkey_ricardian = R"(
+This action registers `key` as the key `member` signs ballots with, so that a relayer can submit their rankings with `submitballots`. Replaces any key registered before.
+)";
+
+const char* eden_fractal::setchainid_ricardian = R"(
+Only callable by the contract account. Sets the id of the chain the contract runs on, which every ballot relayed with `submitballots` is signed for.
+)";
+
+const char* eden_fractal::submitballots_ricardian = R"(
+This action submits `ballots`, consensus rankings signed off-chain with their signers' registered ballot keys, on behalf of the signers. `relayer` pays for the storage. Every ballot counts as its signer's own submission, and each nonce can be used once.
+)";
+
 const char* eden_fractal::startelect_ricardian = R"(
 Only callable by an admin. This action increments the election number and sets timer for the election.)";
 
+const char* eden_fractal::checkin_ricardian = R"(
+This action checks `member` in to the current election so that they are assigned to a group. Only members who signed the agreement can check in, and only after the seed was committed.
+)";
+const char* eden_fractal::commitseed_ricardian = R"(
+Only callable by an admin. Commits the hash of the seed that will be used to shuffle the members of the current election into groups. The seed must be committed before the first check-in.
+)";
+const char* eden_fractal::formgroups_ricardian = R"(
+Only callable by an admin. Reveals the committed seed and assigns up to `max_steps` checked-in members to balanced groups. Call repeatedly until all members are assigned.
+)";
+const char* eden_fractal::advanceround_ricardian = R"(
+Only callable by an admin. Promotes the `promote` top-ranked members of each room of the current round of the election into balanced groups of the next round, processing up to `max_steps` rows. Call repeatedly until the next round is formed.
+)";
+
 const char* eden_fractal::setagreement_ricardian = R"(
 This action updates the Eden Fractal membership agreement that all community members are required to sign to participate.
 )";
@@ -20,6 +49,12 @@ This action indicates that you agree to the mission and rules set forth within t
 const char* eden_fractal::unsign_ricardian = R"(
 This action indicates that you no longer agree to the mission or rules set forth within the current version of the Eden Fractal membership agreement stored in this contract. It will also free any RAM you've allocated to store your signature.
 )";
+const char* eden_fractal::importsigs_ricardian = R"(
+Only callable by the contract account. Records that each of `signers` signed version `version` of the Eden Fractal membership agreement, for members who signed it before this contract did. Members who already signed are skipped.
+)";
+const char* eden_fractal::purgesigs_ricardian = R"(
+Only callable by the contract account. Visits up to `max_rows` signatures and removes those of an older version of the agreement than the current one. Call repeatedly until no outdated signatures are left.
+)";
 
 const char* eden_fractal::create_ricardian = R"(
 This contract does not allow for the creation of arbitrary assets, it only manages the Eden token.
@@ -39,6 +74,12 @@ Allows `ram_payer` to pay to create an account `owner` with zero balance for tok
 const char* eden_fractal::close_ricardian = R"(
 The opposite for open, it closes the account `owner` (balance must be 0).
 )";
+const char* eden_fractal::transfermany_ricardian = R"(
+Transfers each `quantity` in `transfers` from `from` to its `to` account, with the same `memo`. Recipients are only notified if `notify_recipients` is set.
+)";
+const char* eden_fractal::openmany_ricardian = R"(
+Allows `ram_payer` to pay to create a zero EDEN balance for each account in `owners`.
+)";
 
 const char* eden_fractal::eosrewardamt_ricardian = R"(
 Only callable by an admin. Sets the total amount of EOS used for distributions after meetings.
@@ -47,6 +88,48 @@ const char* eden_fractal::fiboffset_ricardian = R"(
 Only callable by an admin. Sets the 0-based index of the fibonacci sequence used for native token distribution to rank 1 
 (e.g. if offset = 5, rank 1 members will be allocated 8 new tokens)
 )";
+const char* eden_fractal::setrewardcfg_ricardian = R"(
+Only callable by the contract account. Sets the minimum number of groups per distribution, the allowed group sizes, and the EOS weight of each rank of the largest group. The reward tables used by distributions are computed from them once, when they are set.
+)";
+const char* eden_fractal::setdecay_ricardian = R"(
+Only callable by the contract account. Sets the share of respect, in parts per million, that members keep from one election to the next.
+)";
 const char* eden_fractal::submitranks_ricardian = R"(
 Only callable by an admin. Submits all group rankings. Order each group in the order they rank (rank 1 first, rank 6 last).
 )";
+const char* eden_fractal::distribcons_ricardian = R"(
+Only callable by the contract account. Distributes the rewards of the current election like `submitranks`, using the consensus ranking of every group formed for the election. Submissions that don't rank exactly the members of their group are ignored.
+)";
+const char* eden_fractal::logdistrib_ricardian = R"(
+Only callable by the contract itself. Records every member's rank and EDEN and EOS rewards of a distribution in one action. It has no other effect.
+)";
+const char* eden_fractal::membernotifs_ricardian = R"(
+Only callable by the contract account. Sets whether distributions notify each ranked member. EDEN is always credited to balances directly.
+)";
+const char* eden_fractal::setroot_ricardian = R"(
+Only callable by the contract account. Settles the rewards of election `electionNr` by storing the Merkle root of its (member, eden, eos) reward leaves, at most 65536 of them. Members claim their rewards with claimproof.
+)";
+const char* eden_fractal::claimproof_ricardian = R"(
+Pays the EDEN and EOS rewards in `leaf` to its member, if `proof` shows that the leaf is part of the reward root of election `electionNr` and it was not claimed yet.
+)";
+const char* eden_fractal::migrate_ricardian = R"(
+Only callable by the contract account. Upgrades up to `max_rows` rows of `table` to its latest layout. Call repeatedly until no rows are left to upgrade.
+)";
+const char* eden_fractal::respectof_ricardian = R"(
+Read-only. Returns the EDEN and EOS rewarded to `member` in the elections `from_election` through `to_election`, and the number of those elections in which they were ranked.
+)";
+const char* eden_fractal::powerof_ricardian = R"(
+Read-only. Returns the respect of `member` decayed to the current election: the EDEN they earned, where EDEN from each past election counts for the share set by `setdecay` per election since.
+)";
+const char* eden_fractal::consensusof_ricardian = R"(
+Read-only. Returns the consensus ranking of group `groupnr` in the current election: the ranking that disagrees least with the submitted rankings, counting the pairs of members each submission orders differently.
+)";
+const char* eden_fractal::getstats_ricardian = R"(
+Read-only. Returns the number of signers and EDEN holders, and the submissions, reporting groups and EDEN minted of the current election.
+)";
+const char* eden_fractal::exportstate_ricardian = R"(
+Read-only. Returns up to `limit` EDEN holders, starting at account `cursor`, with their balance and the agreement version they signed, and the cursor of the next page.
+)";
+const char* eden_fractal::balanceat_ricardian = R"(
+Read-only. Returns the EDEN balance `owner` held at the end of election `electionNr`.
+)";
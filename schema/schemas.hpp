@@ -1,12 +1,64 @@
 #pragma once
 
 #include <eosio/asset.hpp>
-#include <eosio/eosio.hpp>
+#include <eosio/crypto.hpp>
 #include <eosio/name.hpp>
+#include <optional>
 #include <string>
+#include <type_traits>
+#include <variant>
+
+// The schemas are also compiled natively by the off-chain tools in tools/, which only have the core eosio headers
+#ifdef __wasm__
+#include <eosio/eosio.hpp>
+#else
+#include <eosio/operators.hpp>
+#include <eosio/reflection.hpp>
+#include <eosio/time.hpp>
+#endif
 
 namespace eden_fractal {
 
+    // Versioned rows
+    //
+    // A table whose layout may change stores `XxxRow { std::variant<XxxV0, XxxV1, ...> value; }`, and the code only
+    // works with the latest layout. Each `upgrade_row(const XxxVn&)` overload converts one layout to the next.
+    // `latest` chains them, so old rows are upgraded when they are read, and rewritten either the next time they
+    // are written or in bounded batches by the `migrate` action.
+    template <typename Variant>
+    using latest_of = std::variant_alternative_t<std::variant_size_v<Variant> - 1, Variant>;
+
+    template <typename Latest, typename T>
+    Latest upgrade_to(const T& row)
+    {
+        if constexpr (std::is_same_v<T, Latest>) {
+            return row;
+        }
+        else {
+            return upgrade_to<Latest>(upgrade_row(row));
+        }
+    }
+
+    template <typename Variant>
+    latest_of<Variant> latest(const Variant& value)
+    {
+        return std::visit([](const auto& row) { return upgrade_to<latest_of<Variant>>(row); }, value);
+    }
+
+    template <typename Variant>
+    bool is_latest(const Variant& value)
+    {
+        return value.index() == std::variant_size_v<Variant> - 1;
+    }
+
+    struct MigrationCursor {
+        eosio::name table;
+        uint64_t cursor;  // Primary key of the next row to upgrade
+
+        uint64_t primary_key() const { return table.value; }
+    };
+    EOSIO_REFLECT(MigrationCursor, table, cursor);
+
     //Consesus submission related
     struct Consenzus {
         std::vector<eosio::name> rankings;
@@ -20,12 +72,204 @@ namespace eden_fractal {
     EOSIO_REFLECT(Consenzus, rankings, groupNr, submitter);
     EOSIO_COMPARE(Consenzus);
 
+    // A ranking co-signed by several members of a group in one transaction
+    struct GroupConsensus {
+        uint64_t id;
+        uint64_t groupNr;
+        std::vector<eosio::name> rankings;
+        uint8_t signerMask;  // Bit i is set when rankings[i] signed this ranking
+
+        uint64_t primary_key() const { return id; }
+
+        uint64_t get_secondary_1() const { return groupNr; }
+
+        bool signed_by(eosio::name member) const
+        {
+            for (size_t i = 0; i < rankings.size(); ++i) {
+                if (rankings[i] == member) {
+                    return (signerMask >> i) & 1;
+                }
+            }
+            return false;
+        }
+    };
+    EOSIO_REFLECT(GroupConsensus, id, groupNr, rankings, signerMask);
+
+    // One row per member who co-signed a group ranking, so a second vote is caught in any room of the round
+    struct CoSigner {
+        eosio::name member;
+        uint64_t groupNr;
+
+        uint64_t primary_key() const { return member.value; }
+    };
+    EOSIO_REFLECT(CoSigner, member, groupNr);
+
+    // A consensus ranking signed off-chain with the signer's ballot key, so a relayer can submit it (see ballots.hpp)
+    struct Ballot {
+        eosio::name signer;
+        uint64_t electionNr;
+        uint64_t groupnr;
+        std::vector<eosio::name> ranking;
+        uint64_t nonce;  // Must exceed the nonce of the signer's previous ballot
+    };
+    EOSIO_REFLECT(Ballot, signer, electionNr, groupnr, ranking, nonce);
+
+    struct SignedBallot {
+        Ballot ballot;
+        eosio::signature signature;
+    };
+    EOSIO_REFLECT(SignedBallot, ballot, signature);
+
+    // The key a member signs ballots with, and the nonce of their last accepted ballot
+    struct BallotKey {
+        eosio::name member;
+        eosio::public_key key;
+        uint64_t lastNonce;
+
+        uint64_t primary_key() const { return member.value; }
+    };
+    EOSIO_REFLECT(BallotKey, member, key, lastNonce);
+
+    // The chain ballots are signed for, see ballots.hpp
+    struct BallotConfig {
+        eosio::checksum256 chainId;
+    };
+    EOSIO_REFLECT(BallotConfig, chainId);
+
+    // Elections a member took part in (submitted a consensus ranking or was ranked), one bit per election
+    struct Attendance {
+        eosio::name member;
+        uint64_t lastElection;  // Latest election attended, bit 0 of `elections`
+        uint64_t elections;     // Bit i is set when the member attended election lastElection - i
+        uint32_t streak;        // Consecutive elections attended, up to and including lastElection
+
+        uint64_t primary_key() const { return member.value; }
+
+        void mark(uint64_t electionNr)
+        {
+            if (electionNr > lastElection) {
+                auto gap = electionNr - lastElection;
+                elections = (gap < 64) ? (elections << gap) | 1 : 1;
+                streak = (gap == 1) ? streak + 1 : 1;
+                lastElection = electionNr;
+            }
+            else if (lastElection - electionNr < 64) {
+                elections |= uint64_t{1} << (lastElection - electionNr);
+            }
+        }
+
+        // Number of elections attended among the `window` (at most 64) elections up to and including electionNr
+        uint32_t attended(uint64_t electionNr, uint32_t window) const
+        {
+            auto offset = electionNr >= lastElection ? electionNr - lastElection : 0;
+            if (offset >= window) {
+                return 0;
+            }
+            auto bits = elections;
+            if (electionNr < lastElection) {
+                auto skip = lastElection - electionNr;
+                bits = skip < 64 ? bits >> skip : 0;
+            }
+            auto width = window - offset;
+            auto mask = width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+            return __builtin_popcountll(bits & mask);
+        }
+
+        // Streak as of electionNr: it is still running if the member attended electionNr or the election before it
+        uint32_t current_streak(uint64_t electionNr) const { return (lastElection == electionNr || lastElection + 1 == electionNr) ? streak : 0; }
+    };
+    EOSIO_REFLECT(Attendance, member, lastElection, elections, streak);
+
     struct ElectionInf {
         uint64_t electionNr;
         eosio::time_point_sec starttime;
     };
     EOSIO_REFLECT(ElectionInf, electionNr, starttime);
 
+    // Operational counters, updated by the actions that change them so they never need a table scan
+    struct GlobalStats {
+        uint64_t edenHolders;  // Accounts with a non-zero EDEN balance
+    };
+    EOSIO_REFLECT(GlobalStats, edenHolders);
+
+    struct ElectionStats {
+        uint64_t electionNr;
+        int64_t edenMinted;
+
+        uint64_t primary_key() const { return electionNr; }
+    };
+    EOSIO_REFLECT(ElectionStats, electionNr, edenMinted);
+
+    // Counts that would make every signer or submitter write one shared row are taken when read instead
+    struct StatsSummary {
+        uint64_t signers;         // Accounts that signed the agreement
+        uint32_t submissions;     // Consensus submissions of the current election, counting every co-signer of a group submission
+        uint32_t groupsReported;  // Groups of the current election with at least one submission
+        GlobalStats global;
+        ElectionStats election;  // Of the current election
+    };
+    EOSIO_REFLECT(StatsSummary, signers, submissions, groupsReported, global, election);
+
+    // Group formation related
+    struct CheckIn {
+        eosio::name member;
+        uint64_t shuffleKey;
+
+        uint64_t primary_key() const { return member.value; }
+
+        uint64_t get_secondary_1() const { return shuffleKey; }
+    };
+    EOSIO_REFLECT(CheckIn, member, shuffleKey);
+
+    struct Roster {
+        uint64_t groupNr;
+        std::vector<eosio::name> members;
+
+        uint64_t primary_key() const { return groupNr; }
+    };
+    EOSIO_REFLECT(Roster, groupNr, members);
+
+    struct GroupFormation {
+        enum Stage : uint8_t { open = 0, keying = 1, assigning = 2, done = 3 };
+
+        uint64_t electionNr;
+        uint8_t stage;
+        eosio::checksum256 seedHash;
+        uint64_t numCheckedIn;
+
+        // Progress and resume point of the current stage
+        uint64_t numProcessed;
+        uint64_t cursorKey;
+        eosio::name cursorMember;
+    };
+    EOSIO_REFLECT(GroupFormation, electionNr, stage, seedHash, numCheckedIn, numProcessed, cursorKey, cursorMember);
+
+    // Round of an election. Round 0 are the groups of formgroups, each later round is formed from the top-ranked
+    // members of the rooms of the round before. Kept next to ElectionInf, whose singleton layout predates rounds.
+    struct ElectionRound {
+        enum Stage : uint8_t { ranking = 0, promoting = 1, assigning = 2 };
+
+        uint64_t electionNr;
+        uint8_t round;
+        uint8_t stage;
+        uint8_t promote;  // Members promoted per room by the advance in progress
+
+        // Progress and resume point of the current stage
+        uint64_t numPromoted;
+        uint64_t numProcessed;
+        uint64_t cursorGroup;
+    };
+    EOSIO_REFLECT(ElectionRound, electionNr, round, stage, promote, numPromoted, numProcessed, cursorGroup);
+
+    // A member promoted to the next round, in promotion order. Erased once assigned to a roster.
+    struct Promotion {
+        uint64_t position;
+        eosio::name member;
+
+        uint64_t primary_key() const { return position; }
+    };
+    EOSIO_REFLECT(Promotion, position, member);
+
     /*
 
     struct Consensus {
@@ -56,11 +300,33 @@ namespace eden_fractal {
     };
     EOSIO_REFLECT(Agreement, agreement, versionNr);
 
-    struct Signature {
+    // Also the layout of the unversioned legacy "signatures" table
+    struct SignatureV0 {
         eosio::name signer;
         uint64_t primary_key() const { return signer.value; }
     };
-    EOSIO_REFLECT(Signature, signer);
+    EOSIO_REFLECT(SignatureV0, signer);
+
+    struct SignatureV1 {
+        eosio::name signer;
+        uint8_t agreementVersion;  // versionNr of the agreement that was signed, 0 if signed before versions were recorded
+
+        uint64_t primary_key() const { return signer.value; }
+    };
+    EOSIO_REFLECT(SignatureV1, signer, agreementVersion);
+
+    inline SignatureV1 upgrade_row(const SignatureV0& row)
+    {
+        return SignatureV1{.signer = row.signer, .agreementVersion = 0};
+    }
+
+    using Signature = SignatureV1;
+    struct SignatureRow {
+        std::variant<SignatureV0, SignatureV1> value;
+
+        uint64_t primary_key() const { return latest(value).signer.value; }
+    };
+    EOSIO_REFLECT(SignatureRow, value);
 
     // Token-related
     struct account {
@@ -79,12 +345,180 @@ namespace eden_fractal {
     };
     EOSIO_REFLECT(currency_stats, supply, max_supply, issuer);
 
+    struct TokenTransfer {
+        eosio::name to;
+        eosio::asset quantity;
+    };
+    EOSIO_REFLECT(TokenTransfer, to, quantity);
+
+    // Index of the accounts with a non-zero EDEN balance, so they can be listed without enumerating `accounts` scopes
+    struct Holder {
+        eosio::name owner;
+
+        uint64_t primary_key() const { return owner.value; }
+    };
+    EOSIO_REFLECT(Holder, owner);
+
+    struct HolderState {
+        eosio::name owner;
+        int64_t balance;                       // In the smallest unit of EDEN
+        std::optional<uint8_t> signedVersion;  // Agreement version the owner signed, if they signed
+    };
+    EOSIO_REFLECT(HolderState, owner, balance, signedVersion);
+
+    struct StateExport {
+        std::vector<HolderState> records;
+        eosio::name next;  // Cursor of the next page, empty once the export is complete
+    };
+    EOSIO_REFLECT(StateExport, records, next);
+
+    // EDEN balance of an account as of the end of an election, scoped by account. A row is only written for the
+    // elections in which the balance changed, plus one for the balance before the account's first change.
+    struct BalanceCheckpoint {
+        uint64_t electionNr;
+        int64_t balance;  // In the smallest unit of EDEN
+
+        uint64_t primary_key() const { return electionNr; }
+    };
+    EOSIO_REFLECT(BalanceCheckpoint, electionNr, balance);
+
     // Ranking-related
-    struct RewardConfig {
+    // Also the layout of the unversioned legacy "rewardconf" singleton
+    struct RewardConfigV0 {
+        int64_t eos_reward_amt;
+        uint8_t fib_offset;
+    };
+    EOSIO_REFLECT(RewardConfigV0, eos_reward_amt, fib_offset);
+
+    struct RewardConfigV1 {
         int64_t eos_reward_amt;
         uint8_t fib_offset;
+        uint8_t min_groups;
+        uint8_t min_group_size;
+        uint8_t max_group_size;
+        std::vector<double> eos_curve;  // EOS weight per rank index, max_group_size entries, see RewardTables
+    };
+    EOSIO_REFLECT(RewardConfigV1, eos_reward_amt, fib_offset, min_groups, min_group_size, max_group_size, eos_curve);
+
+    // Before V1, the group sizes and the curve were fixed: powers of phi over groups of 5 or 6, in at least 2 groups
+    inline RewardConfigV1 upgrade_row(const RewardConfigV0& row)
+    {
+        return RewardConfigV1{.eos_reward_amt = row.eos_reward_amt,
+                              .fib_offset = row.fib_offset,
+                              .min_groups = 2,
+                              .min_group_size = 5,
+                              .max_group_size = 6,
+                              .eos_curve = {1, 1.618, 2.617924, 4.235801032, 6.85352607, 11.08900518}};
+    }
+
+    using RewardConfig = RewardConfigV1;
+    struct RewardConfigRow {
+        std::variant<RewardConfigV0, RewardConfigV1> value;
+    };
+    EOSIO_REFLECT(RewardConfigRow, value);
+
+    // Everything a distribution needs from the reward config, computed once whenever the config is set.
+    //
+    // Amounts are indexed by rank index: the member at 1-based `position` in a group of `size` gets rank index
+    // max_group_size - size + position - 1, so every group size uses the top of the same curve.
+    struct RewardTables {
+        uint8_t min_groups;
+        uint8_t min_group_size;
+        uint8_t max_group_size;
+        std::vector<int64_t> edenByRank;  // EDEN per rank index, in the smallest unit
+        std::vector<double> eosWeights;   // EOS weight per rank index
+        double eosWeightSum;
+        int64_t eosRewardAmt;  // EOS shared by all groups, in the smallest unit
+    };
+    EOSIO_REFLECT(RewardTables, min_groups, min_group_size, max_group_size, edenByRank, eosWeights, eosWeightSum, eosRewardAmt);
+
+    // Powers of the per-election respect retention factor r in Q32 fixed point (1.0 = 2^32), see decay.hpp.
+    // r^n = wrap^(n / 4096) * high[n % 4096 / 64] * low[n % 64]
+    struct DecayTables {
+        uint32_t retainPpm;          // r in parts per million, 1'000'000 is no decay
+        std::vector<uint64_t> low;   // r^0 .. r^63
+        std::vector<uint64_t> high;  // r^0, r^64, .. r^(64 * 63)
+        uint64_t wrap;               // r^4096
+    };
+    EOSIO_REFLECT(DecayTables, retainPpm, low, high, wrap);
+
+    // EDEN earned by a member, decayed up to election `lastElection`. It is only decayed further when it is next
+    // credited, so members who earn nothing are never rewritten.
+    struct Respect {
+        eosio::name member;
+        int64_t raw;
+        uint64_t lastElection;
+
+        uint64_t primary_key() const { return member.value; }
+    };
+    EOSIO_REFLECT(Respect, member, raw, lastElection);
+
+    struct DistribConfig {
+        bool member_notifs;  // Send an issue and a transfer action per member, rather than crediting balances directly
+    };
+    EOSIO_REFLECT(DistribConfig, member_notifs);
+
+    struct DistributionRecord {
+        eosio::name member;
+        uint8_t rank;  // Rank index of the reward tables (see rewards::rank_index): 0 is the lowest-rewarded rank
+        int64_t eden;  // Amounts in the smallest unit of EDEN and EOS
+        int64_t eos;
+    };
+    EOSIO_REFLECT(DistributionRecord, member, rank, eden, eos);
+
+    // Final results of one distribution, packed to a few bytes per ranked member
+    struct ElectionResults {
+        uint64_t electionNr;
+        std::vector<int64_t> edenByRank;  // EDEN amount paid per rank index
+        std::vector<int64_t> eosByRank;   // EOS amount paid per rank index
+        std::vector<uint32_t> memberIds;  // Ranked members, see MemberId. Sorted ascending
+        std::vector<uint8_t> rankIndices;  // 4-bit rank index of memberIds[i], two per byte, low nibble first
+
+        uint64_t primary_key() const { return electionNr; }
+
+        uint8_t rank_index(size_t i) const { return (rankIndices[i / 2] >> ((i % 2) * 4)) & 0xF; }
+    };
+    EOSIO_REFLECT(ElectionResults, electionNr, edenByRank, eosByRank, memberIds, rankIndices);
+
+    struct MemberId {
+        uint64_t id;
+        eosio::name member;
+
+        uint64_t primary_key() const { return id; }
+
+        uint64_t get_secondary_1() const { return member.value; }
+    };
+    EOSIO_REFLECT(MemberId, id, member);
+
+    struct RespectSummary {
+        eosio::asset eden;
+        eosio::asset eos;
+        uint32_t elections;
+    };
+    EOSIO_REFLECT(RespectSummary, eden, eos, elections);
+
+    // Merkle-root settlement
+    struct RewardLeaf {
+        uint32_t index;  // Position in the tree, and bit in Settlement::claimed
+        eosio::name member;
+        int64_t eden;
+        int64_t eos;
+    };
+    EOSIO_REFLECT(RewardLeaf, index, member, eden, eos);
+
+    struct Settlement {
+        uint64_t electionNr;
+        eosio::checksum256 root;
+        uint32_t numLeaves;
+        int64_t edenRemaining;  // Claims can never exceed the totals committed with the root
+        int64_t eosRemaining;
+        std::vector<uint64_t> claimed;  // One bit per leaf
+
+        uint64_t primary_key() const { return electionNr; }
+
+        bool is_claimed(uint32_t index) const { return (claimed[index / 64] >> (index % 64)) & 1; }
     };
-    EOSIO_REFLECT(RewardConfig, eos_reward_amt, fib_offset);
+    EOSIO_REFLECT(Settlement, electionNr, root, numLeaves, edenRemaining, eosRemaining, claimed);
 
     struct GroupRanking {
         std::vector<eosio::name> ranking;
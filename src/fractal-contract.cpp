@@ -1,44 +1,338 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
 #include <eosio/action.hpp>
+#include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/name.hpp>
 #include <limits>
-#include <map>
-#include <numeric>
+#include <optional>
 #include <string>
 #include <token/token.hpp>
 
 #include "fractal-contract.hpp"
+#include "merkle.hpp"
 
 using namespace eden_fractal;
 using namespace eden_fractal::errors;
 namespace {
 
     // Some compile-time configuration
-    const vector<name> admins{"dan"_n, "jseymour.gm"_n, "chkmacdonald"_n, "james.vr"_n, "vladislav.x"_n};
+    // Compile-time constants only: globals with dynamic initializers run on every action, because every action starts a new instance
+    constexpr std::array admins{"dan"_n, "jseymour.gm"_n, "chkmacdonald"_n, "james.vr"_n, "vladislav.x"_n};
 
     constexpr int64_t max_supply = static_cast<int64_t>(1'000'000'000e4);
 
-    const auto defaultElectionInf = ElectionInf{.electionNr = (uint64_t)0, .starttime = (time_point_sec)10};
-    const auto eleclimit = seconds(7200);
+    constexpr auto defaultElectionInf = ElectionInf{.electionNr = (uint64_t)0, .starttime = (time_point_sec)10};
+    constexpr auto eleclimit = seconds(7200);
 
-    const auto defaultRewardConfig = RewardConfig{.eos_reward_amt = (int64_t)100e4, .fib_offset = 5};
-    constexpr auto min_groups = size_t{2};
-    constexpr auto min_group_size = size_t{5};
-    constexpr auto max_group_size = size_t{6};
+    constexpr auto defaultRewardConfig = RewardConfigV0{.eos_reward_amt = (int64_t)100e4, .fib_offset = 5};
+    constexpr auto defaultDistribConfig = DistribConfig{.member_notifs = true};
 
-    constexpr std::string_view edenTransferMemo = "Eden fractal respect distribution";
-    constexpr std::string_view eosTransferMemo = "Eden fractal participation $EOS reward";
+    // Signatures written by one importsigs, well within the CPU limit of a transaction
+    constexpr auto max_import_batch = size_t{200};
+
+    // Ballots verified by one submitballots. recover_key dominates, so this is a whole meeting of 20 rooms per transaction
+    constexpr auto max_ballot_batch = size_t{120};
 
-    // Coefficients of 6th order poly where p is phi (ratio between adjacent fibonacci numbers)
-    // xp^0 + xp^1 ...
-    constexpr std::array<double, max_group_size> polyCoeffs{1, 1.618, 2.617924, 4.235801032, 6.85352607, 11.08900518};
+    constexpr std::string_view eosTransferMemo = "Eden fractal participation $EOS reward";
 
     // Other helpers
-    auto fib(auto index) -> decltype(index)
-    {  //
-        return (index <= 1) ? index : fib(index - 1) + fib(index - 2);
+    // Deterministic sort key of a checked-in member, derived from the revealed seed and the election number
+    uint64_t shuffle_key(const std::array<uint8_t, 32>& seed, uint64_t electionNr, name member)
+    {
+        std::array<char, 48> buffer;
+        std::memcpy(buffer.data(), seed.data(), seed.size());
+        std::memcpy(buffer.data() + 32, &electionNr, sizeof(electionNr));
+        std::memcpy(buffer.data() + 40, &member.value, sizeof(member.value));
+
+        auto hash = sha256(buffer.data(), buffer.size()).extract_as_byte_array();
+        uint64_t key;
+        std::memcpy(&key, hash.data(), sizeof(key));
+        return key;
+    }
+
+    uint64_t num_groups(uint64_t numMembers, uint64_t maxGroupSize)
+    {
+        return (numMembers + maxGroupSize - 1) / maxGroupSize;
+    }
+
+    // 0-based group of the member at `position` in the shuffled order.
+    // The first (numMembers % numGroups) groups get one extra member, so group sizes differ by at most one.
+    uint64_t group_of(uint64_t position, uint64_t numMembers, uint64_t numGroups)
+    {
+        auto base = numMembers / numGroups;
+        auto extra = numMembers % numGroups;
+        auto largeSpan = extra * (base + 1);
+        return (position < largeSpan) ? position / (base + 1) : extra + (position - largeSpan) / base;
+    }
+
+    // Rewrites up to `max_rows` rows of a versioned table that aren't in the latest layout yet, starting at primary key `cursor`.
+    // Advances `cursor`, which wraps to 0 once the end of the table is reached.
+    template <typename Table>
+    void upgrade_rows(Table& table, uint64_t& cursor, uint32_t max_rows)
+    {
+        uint32_t visited = 0;
+        auto it = table.lower_bound(cursor);
+        for (; it != table.end() && visited < max_rows; ++it, ++visited) {
+            if (!is_latest(it->value)) {
+                table.modify(it, same_payer, [](auto& row) { row.value = latest(row.value); });
+            }
+            cursor = it->primary_key() + 1;
+        }
+        if (it == table.end()) {
+            cursor = 0;
+        }
+    }
+
+    // Counter updates for globalstats and electstats. Rows are created on first use, paid by the contract
+    void update_global_stats(int64_t edenHolders)
+    {
+        // Emptying a balance from before the counter existed must not wrap the count around
+        auto apply = [](uint64_t counter, int64_t delta) { return delta < 0 && uint64_t(-delta) > counter ? 0 : counter + delta; };
+
+        fractal_contract::GlobalStatsSingleton singleton(default_contract_account, default_contract_account.value);
+        auto stats = singleton.get_or_default(GlobalStats{});
+        stats.edenHolders = apply(stats.edenHolders, edenHolders);
+        singleton.set(stats, default_contract_account);
+    }
+
+    // Keeps the holders index in step with the EDEN balance of `owner` becoming non-zero or zero. Returns the change
+    // in the number of indexed holders, which is what the edenHolders counter counts.
+    int64_t update_holder_index(name owner, bool holds)
+    {
+        fractal_contract::HoldersTable holders(default_contract_account, default_contract_account.value);
+        auto it = holders.find(owner.value);
+        if (holds && it == holders.end()) {
+            holders.emplace(default_contract_account, [&](auto& row) { row.owner = owner; });
+            return 1;
+        }
+        else if (!holds && it != holders.end()) {
+            holders.erase(it);
+            return -1;
+        }
+        return 0;
+    }
+
+    uint64_t current_election()
+    {
+        fractal_contract::ElectionCountSingleton singleton(default_contract_account, default_contract_account.value);
+        return singleton.get_or_default(defaultElectionInf).electionNr;
+    }
+
+    // Adds `amount` EDEN earned in election `electionNr` to the respect of `member`. The row is first decayed to that
+    // election; an amount from before the row's last election (a late claim) is decayed to the row's election instead.
+    void credit_respect(const DecayTables& tables, name member, int64_t amount, uint64_t electionNr)
+    {
+        fractal_contract::RespectTable respect(default_contract_account, default_contract_account.value);
+        auto it = respect.find(member.value);
+        if (it == respect.end()) {
+            respect.emplace(default_contract_account, [&](auto& row) {
+                row.member = member;
+                row.raw = amount;
+                row.lastElection = electionNr;
+            });
+            return;
+        }
+        respect.modify(it, same_payer, [&](auto& row) {
+            if (electionNr >= row.lastElection) {
+                row.raw = decay::decayed(tables, row, electionNr) + amount;
+                row.lastElection = electionNr;
+            }
+            else {
+                row.raw += decay::apply(tables, amount, row.lastElection - electionNr);
+            }
+        });
+    }
+
+    // Records the EDEN balance of `owner` as of the current election after it changed from `previous` to `balance`.
+    // Not called for the contract's own account, whose balance changes on every issue and transfer and is never
+    // looked up by election.
+    // The first checkpoint of an account also records `previous` for the election before, so lookups of earlier
+    // elections find the balance from before the change.
+    void checkpoint_balance(name owner, int64_t previous, int64_t balance, uint64_t electionNr)
+    {
+        fractal_contract::CheckpointsTable checkpoints(default_contract_account, owner.value);
+        auto last = checkpoints.end();
+        if (last != checkpoints.begin()) {
+            --last;
+            if (last->electionNr == electionNr) {
+                checkpoints.modify(last, same_payer, [&](auto& row) { row.balance = balance; });
+                return;
+            }
+        }
+        else if (electionNr > 0) {
+            checkpoints.emplace(default_contract_account, [&](auto& row) {
+                row.electionNr = electionNr - 1;
+                row.balance = previous;
+            });
+        }
+        checkpoints.emplace(default_contract_account, [&](auto& row) {
+            row.electionNr = electionNr;
+            row.balance = balance;
+        });
+    }
+
+    void update_election_stats(uint64_t electionNr, int64_t edenMinted)
+    {
+        fractal_contract::ElectionStatsTable table(default_contract_account, default_contract_account.value);
+        auto it = table.find(electionNr);
+        if (it == table.end()) {
+            table.emplace(default_contract_account, [&](auto& row) { row = ElectionStats{.electionNr = electionNr, .edenMinted = edenMinted}; });
+        }
+        else {
+            table.modify(it, same_payer, [&](auto& row) { row.edenMinted += edenMinted; });
+        }
+    }
+
+    // Write-back cache of the EDEN rows touched by one action.
+    // Each balance row and the stat row is read at most once, updated in memory, and written at most once by flush().
+    class BalanceCache {
+       public:
+        explicit BalanceCache(name contract) : contract(contract), slots(64, empty) {}
+
+        void add(name owner, int64_t amount, name ram_payer)
+        {
+            auto& entry = load(owner);
+            if (!entry.exists && entry.ramPayer == name{}) {
+                entry.ramPayer = ram_payer;
+            }
+            entry.balance += amount;
+        }
+
+        void sub(name owner, int64_t amount)
+        {
+            auto& entry = load(owner);
+            check(entry.exists, "no balance object found");
+            check(entry.balance >= amount, "overdrawn balance");
+            entry.balance -= amount;
+            entry.debited = true;
+        }
+
+        void mint(int64_t amount)
+        {
+            if (!stat) {
+                fractal_contract::stats statstable(contract, eden_symbol.code().raw());
+                stat = statstable.get(eden_symbol.code().raw());
+            }
+            check(amount <= stat->max_supply.amount - stat->supply.amount, "quantity exceeds available supply");
+            stat->supply.amount += amount;
+        }
+
+        void flush()
+        {
+            int64_t holders = 0;
+            auto electionNr = entries.empty() ? 0 : current_election();
+            for (const auto& entry : entries) {
+                if ((entry.loaded == 0) != (entry.balance == 0)) {
+                    holders += update_holder_index(entry.owner, entry.balance != 0);
+                }
+
+                fractal_contract::accounts acnts(contract, entry.owner.value);
+                if (!entry.exists) {
+                    acnts.emplace(entry.ramPayer, [&](auto& a) { a.balance = asset{entry.balance, eden_symbol}; });
+                }
+                else if (entry.balance != entry.loaded) {
+                    // Same payer rules as sub_balance and add_balance
+                    auto payer = entry.debited ? entry.owner : same_payer;
+                    acnts.modify(acnts.get(eden_symbol.code().raw()), payer, [&](auto& a) { a.balance.amount = entry.balance; });
+                }
+                if (entry.balance != entry.loaded && entry.owner != contract) {
+                    checkpoint_balance(entry.owner, entry.loaded, entry.balance, electionNr);
+                }
+            }
+            if (stat) {
+                fractal_contract::stats statstable(contract, eden_symbol.code().raw());
+                statstable.modify(statstable.get(eden_symbol.code().raw()), same_payer, [&](auto& s) { s.supply = stat->supply; });
+            }
+            if (holders != 0) {
+                update_global_stats(holders);
+            }
+            entries.clear();
+            std::fill(slots.begin(), slots.end(), empty);
+            stat.reset();
+        }
+
+       private:
+        struct Entry {
+            name owner;
+            bool exists;
+            bool debited;
+            int64_t loaded;
+            int64_t balance;
+            name ramPayer;
+        };
+
+        static constexpr uint32_t empty = ~uint32_t{0};
+
+        // Open addressing over `entries`, the table size is a power of two kept at least twice the number of entries
+        Entry& load(name owner)
+        {
+            auto mask = slots.size() - 1;
+            auto slot = (owner.value * 0x9E3779B97F4A7C15ull >> 32) & mask;
+            for (; slots[slot] != empty; slot = (slot + 1) & mask) {
+                if (entries[slots[slot]].owner == owner) {
+                    return entries[slots[slot]];
+                }
+            }
+
+            fractal_contract::accounts acnts(contract, owner.value);
+            auto row = acnts.find(eden_symbol.code().raw());
+            auto exists = row != acnts.end();
+            auto amount = exists ? row->balance.amount : 0;
+            entries.push_back(Entry{.owner = owner, .exists = exists, .debited = false, .loaded = amount, .balance = amount});
+            slots[slot] = entries.size() - 1;
+
+            if (entries.size() * 2 > slots.size()) {
+                rehash();
+            }
+            return entries.back();
+        }
+
+        void rehash()
+        {
+            slots.assign(slots.size() * 2, empty);
+            auto mask = slots.size() - 1;
+            for (uint32_t i = 0; i < entries.size(); ++i) {
+                auto slot = (entries[i].owner.value * 0x9E3779B97F4A7C15ull >> 32) & mask;
+                while (slots[slot] != empty) {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = i;
+            }
+        }
+
+        name contract;
+        std::vector<Entry> entries;
+        std::vector<uint32_t> slots;
+        std::optional<currency_stats> stat;
     };
 
+    // Appends `members` to roster `groupNr`, creating the roster on first use
+    void append_to_roster(fractal_contract::RosterTable& rosters, uint64_t groupNr, const std::vector<name>& members)
+    {
+        auto roster = rosters.find(groupNr);
+        if (roster == rosters.end()) {
+            rosters.emplace(default_contract_account, [&](auto& row) {
+                row.groupNr = groupNr;
+                row.members = members;
+            });
+        }
+        else {
+            rosters.modify(roster, same_payer, [&](auto& row) { row.members.insert(row.members.end(), members.begin(), members.end()); });
+        }
+    }
+
+    GroupFormation get_formation(fractal_contract::GroupFormationSingleton& singleton, uint64_t electionNr)
+    {
+        auto formation = singleton.get_or_default(GroupFormation{});
+        if (formation.electionNr != electionNr) {
+            formation = GroupFormation{.electionNr = electionNr, .stage = GroupFormation::open};
+        }
+        return formation;
+    }
+
 }  // namespace
 
 fractal_contract::fractal_contract(name receiver, name code, datastream<const char*> ds) : contract(receiver, code, ds) {}
@@ -64,10 +358,13 @@ void fractal_contract::sign(const name& signer)
     AgreementSingleton singleton(default_contract_account, default_contract_account.value);
     check(singleton.exists(), noAgreement.data());
 
+    auto version = singleton.get().versionNr;
+
     SignersTable table(default_contract_account, default_contract_account.value);
+    LegacySignersTable legacy(default_contract_account, default_contract_account.value);
 
-    if (table.find(signer.value) == table.end()) {
-        table.emplace(signer, [&](auto& row) { row.signer = signer; });
+    if (table.find(signer.value) == table.end() && legacy.find(signer.value) == legacy.end()) {
+        table.emplace(signer, [&](auto& row) { row.value = Signature{.signer = signer, .agreementVersion = version}; });
     }
     else {
         check(false, alreadySigned.data());
@@ -79,7 +376,98 @@ void fractal_contract::unsign(const name& signer)
     require_auth(signer);
     SignersTable table(default_contract_account, default_contract_account.value);
 
-    table.erase(*table.require_find(signer.value, notSigned.data()));
+    auto it = table.find(signer.value);
+    if (it != table.end()) {
+        table.erase(it);
+    }
+    else {
+        LegacySignersTable legacy(default_contract_account, default_contract_account.value);
+        legacy.erase(*legacy.require_find(signer.value, notSigned.data()));
+    }
+}
+
+void fractal_contract::importsigs(const std::vector<name>& signers, uint8_t version)
+{
+    require_auth(get_self());
+    check(signers.size() <= max_import_batch, importBatchTooLarge.data());
+
+    AgreementSingleton singleton(default_contract_account, default_contract_account.value);
+    check(singleton.exists(), noAgreement.data());
+    check(version <= singleton.get().versionNr, unknownAgreementVersion.data());
+
+    SignersTable table(default_contract_account, default_contract_account.value);
+    LegacySignersTable legacy(default_contract_account, default_contract_account.value);
+
+    // Members who already signed keep their signature, so an import can be retried or overlap a previous batch
+    for (const auto& signer : signers) {
+        if (table.find(signer.value) != table.end() || legacy.find(signer.value) != legacy.end()) {
+            continue;
+        }
+        if (!is_account(signer)) {
+            check(false, "account " + signer.to_string() + " does not exist");
+        }
+        table.emplace(get_self(), [&](auto& row) { row.value = Signature{.signer = signer, .agreementVersion = version}; });
+    }
+}
+
+void fractal_contract::purgesigs(uint32_t max_rows)
+{
+    require_auth(get_self());
+    check(max_rows > 0, "max_rows must be positive");
+
+    AgreementSingleton singleton(default_contract_account, default_contract_account.value);
+    check(singleton.exists(), noAgreement.data());
+    auto current = singleton.get().versionNr;
+
+    // Legacy rows predate versioned signatures, so they are always outdated
+    LegacySignersTable legacy(default_contract_account, default_contract_account.value);
+    uint32_t rows = 0;
+    for (auto it = legacy.begin(); it != legacy.end() && rows < max_rows; ++rows) {
+        it = legacy.erase(it);
+    }
+
+    // The cursor skips the rows of current signers that earlier calls already kept
+    MigrationsTable migrations(default_contract_account, default_contract_account.value);
+    auto cursor = migrations.find("purgesigs"_n.value);
+    auto next = (cursor == migrations.end()) ? uint64_t{0} : cursor->cursor;
+
+    SignersTable table(default_contract_account, default_contract_account.value);
+    auto it = table.lower_bound(next);
+    while (it != table.end() && rows < max_rows) {
+        next = it->primary_key() + 1;
+        if (latest(it->value).agreementVersion < current) {
+            it = table.erase(it);
+        }
+        else {
+            ++it;
+        }
+        ++rows;
+    }
+    if (it == table.end()) {
+        next = 0;
+    }
+
+    if (cursor == migrations.end()) {
+        migrations.emplace(get_self(), [&](auto& row) {
+            row.table = "purgesigs"_n;
+            row.cursor = next;
+        });
+    }
+    else {
+        migrations.modify(cursor, same_payer, [&](auto& row) { row.cursor = next; });
+    }
+}
+
+bool fractal_contract::has_signed(const name& signer)
+{
+    // Legacy signatures still count. They are only moved by `migrate`, which bills every moved row to the contract
+    SignersTable table(default_contract_account, default_contract_account.value);
+    if (table.find(signer.value) != table.end()) {
+        return true;
+    }
+
+    LegacySignersTable legacy(default_contract_account, default_contract_account.value);
+    return legacy.find(signer.value) != legacy.end();
 }
 
 /*** Token-related ***/
@@ -187,87 +575,409 @@ void fractal_contract::close(const name& owner, const symbol& symbol)
     acnts.erase(it);
 }
 
+void fractal_contract::transfermany(const name& from, const std::vector<TokenTransfer>& transfers, const string& memo, bool notify_recipients)
+{
+    check(from == get_self(), untradeable.data());
+    require_auth(from);
+
+    check(!transfers.empty(), noTransfers.data());
+    validate_memo(memo);
+
+    int64_t total = 0;
+    for (const auto& t : transfers) {
+        validate_symbol(t.quantity.symbol);
+        validate_quantity(t.quantity);
+        check(t.to != from, "cannot transfer to self");
+        check(is_account(t.to), "to account does not exist");
+
+        total += t.quantity.amount;
+        check(total <= max_supply, "quantity exceeds max supply");
+    }
+
+    require_recipient(from);
+
+    BalanceCache balances(get_self());
+    balances.sub(from, total);
+    for (const auto& t : transfers) {
+        if (notify_recipients) {
+            require_recipient(t.to);
+        }
+        auto payer = has_auth(t.to) ? t.to : from;
+        balances.add(t.to, t.quantity.amount, payer);
+    }
+    balances.flush();
+}
+
+void fractal_contract::openmany(const std::vector<name>& owners, const name& ram_payer)
+{
+    require_auth(ram_payer);
+
+    for (const auto& owner : owners) {
+        check(is_account(owner), "owner account does not exist");
+        accounts acnts(get_self(), owner.value);
+        check(acnts.find(eden_symbol.code().raw()) == acnts.end(), "specified owner already holds a balance");
+
+        acnts.emplace(ram_payer, [&](auto& a) { a.balance = asset{0, eden_symbol}; });
+    }
+}
+
 void fractal_contract::eosrewardamt(const asset& quantity)
 {
     require_auth(get_self());
 
-    RewardConfigSingleton rewardConfigTable(default_contract_account, default_contract_account.value);
-    auto record = rewardConfigTable.get_or_default(defaultRewardConfig);
+    auto record = get_reward_config();
 
     validate_quantity(quantity);
     check(quantity.symbol == eos_symbol, requiresEosToken.data());
 
     record.eos_reward_amt = quantity.amount;
-    rewardConfigTable.set(record, get_self());
+    set_reward_config(record);
 }
 
 void fractal_contract::fiboffset(uint8_t offset)
 {
     require_auth(get_self());
 
-    RewardConfigSingleton rewardConfigTable(default_contract_account, default_contract_account.value);
-    auto record = rewardConfigTable.get_or_default(defaultRewardConfig);
+    auto record = get_reward_config();
 
     record.fib_offset = offset;
-    rewardConfigTable.set(record, get_self());
+    set_reward_config(record);
+}
+
+void fractal_contract::setrewardcfg(uint8_t min_groups, uint8_t min_group_size, uint8_t max_group_size, const std::vector<double>& eos_curve)
+{
+    require_auth(get_self());
+
+    auto record = get_reward_config();
+
+    record.min_groups = min_groups;
+    record.min_group_size = min_group_size;
+    record.max_group_size = max_group_size;
+    record.eos_curve = eos_curve;
+    set_reward_config(record);
 }
 
 void fractal_contract::submitranks(const AllRankings& ranks)
 {
-    // This action calculates both types of rewards: EOS rewards, and the new token rewards.
     require_auth(get_self());
 
-    RewardConfigSingleton rewardConfigTable(default_contract_account, default_contract_account.value);
-    auto rewardConfig = rewardConfigTable.get_or_default(defaultRewardConfig);
+    distribute(ranks);
+}
+
+void fractal_contract::distribcons()
+{
+    require_auth(get_self());
+
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    auto electionNr = electionSingleton.get_or_default(defaultElectionInf).electionNr;
+
+    // Only the rooms formed by formgroups are rewarded, each with the consensus of the submissions that rank its roster.
+    // Rooms without such a submission are left out.
+    AllRankings ranks;
+    RosterTable rosters(default_contract_account, electionNr);
+    for (auto it = rosters.begin(); it != rosters.end() && round_of(it->groupNr) == 0; ++it) {
+        auto ranking = get_room_consensus(electionNr, *it);
+        if (!ranking.empty()) {
+            ranks.allRankings.push_back(GroupRanking{std::move(ranking)});
+        }
+    }
+    distribute(ranks);
+}
+
+void fractal_contract::distribute(const AllRankings& ranks)
+{
+    // This calculates both types of rewards: EOS rewards, and the new token rewards.
+    auto tables = get_reward_tables();
+
+    // Amounts and the checks that don't need the chain are shared with the reward simulator (see rewards.hpp).
+    // EDEN per rank index comes straight from the tables. EOS is shared by the groups, so it depends on their number.
+    std::string error;
+    auto [records, eosRewards, edenTotal] = rewards::distribution(ranks, tables, error);
+    check(error.empty(), error);
+
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    auto electionNr = electionSingleton.get_or_default(defaultElectionInf).electionNr;
+
+    // One distribution per election, by design: the archive and respect are keyed by election, so a second
+    // submitranks would double count. Checked before anything is minted.
+    ResultsTable results(default_contract_account, default_contract_account.value);
+    check(results.find(electionNr) == results.end(), alreadyDistributed.data());
+    SettlementsTable settlements(default_contract_account, default_contract_account.value);
+    check(settlements.find(electionNr) == settlements.end(), alreadyDistributed.data());
+
+    DistribConfigSingleton distribConfigTable(default_contract_account, default_contract_account.value);
+    auto memberNotifs = distribConfigTable.get_or_default(defaultDistribConfig).member_notifs;
+
+    std::vector<std::pair<name, uint8_t>> ranked;
+    for (const auto& record : records) {
+        // Error strings are only built on failure
+        if (!is_account(record.member)) {
+            check(false, "account " + record.member.to_string() + " DNE");
+        }
+        ranked.emplace_back(record.member, record.rank);
+    }
+
+    // TODO: To better scale this contract, any distributions should not use require_recipient.
+    //       (Otherwise other user contracts could fail this action)
+    // Therefore,
+    //   EOS distribution should be stored, and then accounts can claim the EOS themselves.
+    //   Members are only notified of their EDEN while member notifications are on (see membernotifs).
+
+    // Distribute EDEN. The whole distribution is minted and credited in memory, so the supply and each balance row are
+    // written once. Notified members then receive this action once each, like the recipients of transfermany.
+    BalanceCache balances(get_self());
+    balances.mint(edenTotal);
+    for (const auto& record : records) {
+        balances.add(record.member, record.eden, get_self());
+    }
+    balances.flush();
+    if (memberNotifs) {
+        for (const auto& record : records) {
+            require_recipient(record.member);
+        }
+    }
+
+    // Distribute EOS
+    for (const auto& record : records) {
+        token::actions::transfer{"eosio.token"_n, {get_self(), "active"_n}}.send(get_self(), record.member, asset{record.eos, eos_symbol}, eosTransferMemo.data());
+    }
+
+    // One compact record of the whole distribution for indexers
+    actions::logdistrib(get_self(), {get_self(), "active"_n}).send(electionNr, records);
+
+    archive_results(electionNr, ranked, tables.edenByRank, eosRewards);
+    auto decayTables = get_decay_tables();
+    for (const auto& record : records) {
+        mark_attendance(record.member, electionNr, get_self());
+        credit_respect(decayTables, record.member, record.eden, electionNr);
+    }
+    update_election_stats(electionNr, edenTotal);
+}
 
-    auto numGroups = ranks.allRankings.size();
-    check(numGroups >= min_groups, too_few_groups.data());
+void fractal_contract::logdistrib(uint64_t electionNr, const std::vector<DistributionRecord>& records)
+{
+    // No-op, the records are read from the action trace
+    require_auth(get_self());
+}
 
-    auto coeffSum = std::accumulate(std::begin(polyCoeffs), std::end(polyCoeffs), 0.0);
+void fractal_contract::setroot(uint64_t electionNr, const checksum256& root, uint32_t num_leaves, const asset& eden_total, const asset& eos_total)
+{
+    // Commits a whole distribution in one small row. Members then claim their own leaf with claimproof.
+    require_auth(get_self());
 
-    // Calculation how much EOS per coefficient.
-    auto multiplier = (double)rewardConfig.eos_reward_amt / (numGroups * coeffSum);
+    check(num_leaves > 0, "num_leaves must be positive");
+    check(num_leaves <= max_settlement_leaves, tooManyLeaves.data());
+    validate_symbol(eden_total.symbol);
+    validate_quantity(eden_total);
+    validate_quantity(eos_total);
+    check(eos_total.symbol == eos_symbol, requiresEosToken.data());
+
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    check(electionNr <= electionSingleton.get_or_default(defaultElectionInf).electionNr, futureElection.data());
+
+    ResultsTable results(default_contract_account, default_contract_account.value);
+    check(results.find(electionNr) == results.end(), alreadyDistributed.data());
+    SettlementsTable settlements(default_contract_account, default_contract_account.value);
+    check(settlements.find(electionNr) == settlements.end(), alreadyDistributed.data());
+
+    stats statstable(get_self(), eden_symbol.code().raw());
+    const auto& st = statstable.get(eden_symbol.code().raw());
+    check(eden_total.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
+
+    settlements.emplace(get_self(), [&](auto& row) {
+        row.electionNr = electionNr;
+        row.root = root;
+        row.numLeaves = num_leaves;
+        row.edenRemaining = eden_total.amount;
+        row.eosRemaining = eos_total.amount;
+        row.claimed.assign((num_leaves + 63) / 64, 0);
+    });
+}
 
-    std::vector<int64_t> eosRewards;
-    std::transform(std::begin(polyCoeffs), std::end(polyCoeffs), std::back_inserter(eosRewards), [&](const auto& c) {
-        auto finalEosQuant = static_cast<int64_t>(multiplier * c);
-        check(finalEosQuant > 0, "Total configured EOS distribution is too small to distibute any reward to rank 1s");
-        return finalEosQuant;
+void fractal_contract::claimproof(uint64_t electionNr, const RewardLeaf& leaf, const std::vector<checksum256>& proof)
+{
+    // Anyone may submit the claim, the rewards always go to the member in the leaf
+    SettlementsTable settlements(default_contract_account, default_contract_account.value);
+    const auto& settlement = settlements.get(electionNr, noSettlement.data());
+
+    check(leaf.index < settlement.numLeaves, leafOutOfRange.data());
+    check(!settlement.is_claimed(leaf.index), alreadyClaimed.data());
+    check(merkle::verify(settlement.root, settlement.numLeaves, leaf, proof), invalidProof.data());
+
+    check(leaf.eden >= 0 && leaf.eos >= 0, "quantity must be positive");
+    check(leaf.eden <= settlement.edenRemaining && leaf.eos <= settlement.eosRemaining, "claim exceeds the settled totals");
+    if (!is_account(leaf.member)) {
+        check(false, "account " + leaf.member.to_string() + " DNE");
+    }
+
+    settlements.modify(settlement, same_payer, [&](auto& row) {
+        row.claimed[leaf.index / 64] |= uint64_t{1} << (leaf.index % 64);
+        row.edenRemaining -= leaf.eden;
+        row.eosRemaining -= leaf.eos;
     });
 
-    std::map<name, uint8_t> accounts;
+    if (leaf.eden > 0) {
+        // setroot only checked the total against the supply of its time, tokens may have been minted since
+        auto edenQuantity = asset{leaf.eden, eden_symbol};
+        stats statstable(get_self(), eden_symbol.code().raw());
+        const auto& st = statstable.get(eden_symbol.code().raw());
+        check(edenQuantity.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
+        statstable.modify(st, same_payer, [&](auto& s) { s.supply += edenQuantity; });
+        add_balance(leaf.member, edenQuantity, get_self());
+        update_election_stats(electionNr, leaf.eden);
+        credit_respect(get_decay_tables(), leaf.member, leaf.eden, electionNr);
+    }
+    if (leaf.eos > 0) {
+        token::actions::transfer{"eosio.token"_n, {get_self(), "active"_n}}.send(get_self(), leaf.member, asset{leaf.eos, eos_symbol}, eosTransferMemo.data());
+    }
+}
+
+void fractal_contract::setdecay(uint32_t retain_ppm)
+{
+    // Rows are decayed lazily, so the new factor also applies to the elections since each row was last credited
+    require_auth(get_self());
+    check(retain_ppm > 0 && retain_ppm <= decay::no_decay_ppm, invalidDecay.data());
+
+    DecayTablesSingleton tables(default_contract_account, default_contract_account.value);
+    tables.set(decay::make_tables(retain_ppm), get_self());
+}
+
+RewardTables fractal_contract::get_reward_tables()
+{
+    // Computed on the fly until the config is first set or migrated
+    RewardTablesSingleton tables(default_contract_account, default_contract_account.value);
+    if (tables.exists()) {
+        return tables.get();
+    }
+    return rewards::make_tables(get_reward_config(), eden_symbol.precision());
+}
+
+RewardConfig fractal_contract::get_reward_config()
+{
+    RewardConfigSingleton rewardConfigTable(default_contract_account, default_contract_account.value);
+    if (rewardConfigTable.exists()) {
+        return latest(rewardConfigTable.get().value);
+    }
+
+    LegacyRewardConfigSingleton legacy(default_contract_account, default_contract_account.value);
+    return upgrade_to<RewardConfig>(legacy.get_or_default(defaultRewardConfig));
+}
 
-    for (const auto& rank : ranks.allRankings) {
-        size_t group_size = rank.ranking.size();
-        check(group_size >= min_group_size, group_too_small.data());
-        check(group_size <= max_group_size, group_too_large.data());
+void fractal_contract::set_reward_config(const RewardConfig& config)
+{
+    auto error = rewards::config_error(config);
+    check(error.empty(), error.data());
 
-        auto rankIndex = max_group_size - group_size;
-        for (const auto& acc : rank.ranking) {
-            check(is_account(acc), "account " + acc.to_string() + " DNE");
-            check(0 == accounts[acc]++, "account " + acc.to_string() + " listed more than once");
+    RewardConfigSingleton rewardConfigTable(default_contract_account, default_contract_account.value);
+    rewardConfigTable.set(RewardConfigRow{config}, get_self());
 
-            auto fibAmount = static_cast<int64_t>(fib(rankIndex + rewardConfig.fib_offset));
-            auto edenAmt = static_cast<int64_t>(fibAmount * std::pow(10, eden_symbol.precision()));
-            auto edenQuantity = asset{edenAmt, eden_symbol};
+    // Distributions only read the tables
+    RewardTablesSingleton tables(default_contract_account, default_contract_account.value);
+    tables.set(rewards::make_tables(config, eden_symbol.precision()), get_self());
 
-            // TODO: To better scale this contract, any distributions should not use require_recipient.
-            //       (Otherwise other user contracts could fail this action)
-            // Therefore,
-            //   Eden tokens should be added/subbed from balances directly (without calling transfer)
-            //   and EOS distribution should be stored, and then accounts can claim the EOS themselves.
+    LegacyRewardConfigSingleton legacy(default_contract_account, default_contract_account.value);
+    if (legacy.exists()) {
+        legacy.remove();
+    }
+}
+
+void fractal_contract::membernotifs(bool enabled)
+{
+    require_auth(get_self());
+
+    DistribConfigSingleton distribConfigTable(default_contract_account, default_contract_account.value);
+    auto record = distribConfigTable.get_or_default(defaultDistribConfig);
+
+    record.member_notifs = enabled;
+    distribConfigTable.set(record, get_self());
+}
+
+RespectSummary fractal_contract::respectof(const name& member, uint64_t from_election, uint64_t to_election)
+{
+    return get_respect(member, from_election, to_election);
+}
+
+asset fractal_contract::powerof(const name& member)
+{
+    return get_decayed_respect(member, current_election());
+}
+
+std::vector<name> fractal_contract::consensusof(uint64_t groupnr)
+{
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    return get_group_consensus(electionSingleton.get_or_default(defaultElectionInf).electionNr, groupnr);
+}
+
+StatsSummary fractal_contract::getstats()
+{
+    return get_stats();
+}
 
-            // Distribute EDEN
-            actions::issue(get_self(), {get_self(), "active"_n}).send(get_self(), edenQuantity, "Mint new Eden tokens");
-            actions::transfer(get_self(), {get_self(), "active"_n}).send(get_self(), acc, edenQuantity, edenTransferMemo.data());
+StateExport fractal_contract::exportstate(const name& cursor, uint32_t limit)
+{
+    check(limit > 0, "limit must be positive");
+    return get_state_export(cursor, limit);
+}
 
-            // Distribute EOS
-            check(eosRewards.size() > rankIndex, "Shouldn't happen.");  // Indicates that the group is too large, but we already check for that?
-            auto eosQuantity = asset{eosRewards[rankIndex], eos_symbol};
-            token::actions::transfer{"eosio.token"_n, {get_self(), "active"_n}}.send(get_self(), acc, eosQuantity, eosTransferMemo.data());
+asset fractal_contract::balanceat(const name& owner, uint64_t electionNr)
+{
+    return get_balance_at(owner, electionNr);
+}
 
-            ++rankIndex;
+void fractal_contract::archive_results(uint64_t electionNr,
+                                       const std::vector<std::pair<name, uint8_t>>& ranked,
+                                       const std::vector<int64_t>& edenRewards,
+                                       const std::vector<int64_t>& eosRewards)
+{
+    std::vector<std::pair<uint32_t, uint8_t>> packed;
+    packed.reserve(ranked.size());
+    for (const auto& [member, rankIndex] : ranked) {
+        packed.emplace_back(member_id(member), rankIndex);
+    }
+    std::sort(packed.begin(), packed.end());
+
+    ResultsTable results(default_contract_account, default_contract_account.value);
+    results.emplace(get_self(), [&](auto& row) {
+        row.electionNr = electionNr;
+        row.edenByRank = edenRewards;
+        row.eosByRank = eosRewards;
+        row.memberIds.reserve(packed.size());
+        row.rankIndices.assign((packed.size() + 1) / 2, 0);
+        for (size_t i = 0; i < packed.size(); ++i) {
+            row.memberIds.push_back(packed[i].first);
+            row.rankIndices[i / 2] |= packed[i].second << ((i % 2) * 4);
         }
+    });
+}
+
+uint32_t fractal_contract::member_id(const name& member)
+{
+    MembersTable members(default_contract_account, default_contract_account.value);
+    auto byMember = members.get_index<"bymember"_n>();
+
+    auto it = byMember.find(member.value);
+    if (it != byMember.end()) {
+        return static_cast<uint32_t>(it->id);
+    }
+
+    auto id = members.available_primary_key();
+    check(id <= std::numeric_limits<uint32_t>::max(), "member id overflow");
+    members.emplace(get_self(), [&](auto& row) {
+        row.id = id;
+        row.member = member;
+    });
+    return static_cast<uint32_t>(id);
+}
+
+void fractal_contract::mark_attendance(const name& member, uint64_t electionNr, const name& ram_payer)
+{
+    AttendanceTable table(default_contract_account, default_contract_account.value);
+    auto it = table.find(member.value);
+    if (it == table.end()) {
+        table.emplace(ram_payer, [&](auto& row) { row = Attendance{.member = member, .lastElection = electionNr, .elections = 1, .streak = 1}; });
+    }
+    else if (it->lastElection != electionNr) {
+        table.modify(it, same_payer, [&](auto& row) { row.mark(electionNr); });
     }
 }
 
@@ -277,37 +987,164 @@ void fractal_contract::submitcons(const uint64_t& groupnr, const std::vector<nam
 {
     require_auth(submitter);
 
-    size_t group_size = rankings.size();
-
-    check(group_size >= min_group_size, group_too_small.data());
-    check(group_size <= max_group_size, group_too_large.data());
-
     check(is_account(submitter), "Submitter's account does not exist.");
 
-    for (size_t i = 0; i < rankings.size(); i++) {
-        std::string rankname = rankings[i].to_string();
-
-        check(is_account(rankings[i]), rankname + " account does not exist.");
-    }
+    validate_ranking(rankings);
 
-    check(groupnr >= 1, "Group number error.");
+    check(groupnr >= 1 && round_of(groupnr) <= max_round, "Group number error.");
 
     ElectionCountSingleton singleton(default_contract_account, default_contract_account.value);
     auto serks = singleton.get_or_default(defaultElectionInf);
 
     check(serks.starttime + eleclimit > current_time_point(), electionEnded.data());
 
-    ConsenzusTable table(default_contract_account, serks.electionNr);
+    record_submission(serks.electionNr, groupnr, rankings, submitter, submitter);
+}
+
+void fractal_contract::record_submission(uint64_t electionNr, uint64_t groupnr, const std::vector<name>& rankings, const name& submitter, const name& ram_payer)
+{
+    ConsenzusTable table(default_contract_account, submission_scope(electionNr, groupnr));
 
     if (table.find(submitter.value) == table.end()) {
-        table.emplace(submitter, [&](auto& row) {
+        CoSignersTable cosigners(default_contract_account, submission_scope(electionNr, groupnr));
+        check(cosigners.find(submitter.value) == cosigners.end(), alreadySubmitted.data());
+
+        mark_attendance(submitter, electionNr, ram_payer);
+        table.emplace(ram_payer, [&](auto& row) {
             row.rankings = rankings;
             row.submitter = submitter;
             row.groupNr = groupnr;
         });
     }
     else {
-        check(false, "You can vote only once my friend.");
+        check(false, alreadySubmitted.data());
+    }
+}
+
+void fractal_contract::submitgroup(const uint64_t& electionNr, const uint64_t& groupnr, const std::vector<name>& rankings, const std::vector<name>& signers)
+{
+    // One transaction for a whole room: the ranking is validated once and stored once, with a bit per co-signer
+    check(!signers.empty(), noSigners.data());
+    for (const auto& signer : signers) {
+        require_auth(signer);
+    }
+
+    validate_ranking(rankings);
+
+    check(groupnr >= 1 && round_of(groupnr) <= max_round, "Group number error.");
+
+    ElectionCountSingleton singleton(default_contract_account, default_contract_account.value);
+    auto election = singleton.get_or_default(defaultElectionInf);
+
+    check(election.electionNr == electionNr, wrongElection.data());
+    check(election.starttime + eleclimit > current_time_point(), electionEnded.data());
+
+    // Both tables are scoped per round rather than per group, so a member who voted in any room of the round is caught
+    ConsenzusTable individual(default_contract_account, submission_scope(election.electionNr, groupnr));
+    CoSignersTable cosigners(default_contract_account, submission_scope(election.electionNr, groupnr));
+
+    uint8_t signerMask = 0;
+    for (const auto& signer : signers) {
+        auto pos = std::find(rankings.begin(), rankings.end(), signer);
+        check(pos != rankings.end(), signerNotInGroup.data());
+
+        auto bit = uint8_t(1 << (pos - rankings.begin()));
+        check((signerMask & bit) == 0, duplicateSigner.data());
+        signerMask |= bit;
+
+        check(individual.find(signer.value) == individual.end(), alreadySubmitted.data());
+        check(cosigners.find(signer.value) == cosigners.end(), alreadySubmitted.data());
+    }
+
+    GroupConsensusTable table(default_contract_account, submission_scope(election.electionNr, groupnr));
+    auto byGroup = table.get_index<"bygroupnr"_n>();
+
+    auto existing = table.end();
+    for (auto it = byGroup.lower_bound(groupnr); it != byGroup.end() && it->groupNr == groupnr; ++it) {
+        if (it->rankings == rankings) {
+            existing = table.iterator_to(*it);
+            break;
+        }
+    }
+
+    for (const auto& signer : signers) {
+        mark_attendance(signer, election.electionNr, signer);
+        cosigners.emplace(signer, [&](auto& row) {
+            row.member = signer;
+            row.groupNr = groupnr;
+        });
+    }
+
+    if (existing == table.end()) {
+        table.emplace(signers.front(), [&](auto& row) {
+            row.id = table.available_primary_key();
+            row.groupNr = groupnr;
+            row.rankings = rankings;
+            row.signerMask = signerMask;
+        });
+    }
+    else {
+        table.modify(existing, same_payer, [&](auto& row) { row.signerMask |= signerMask; });
+    }
+}
+
+void fractal_contract::setballotkey(const name& member, const public_key& key)
+{
+    require_auth(member);
+
+    BallotKeysTable table(default_contract_account, default_contract_account.value);
+    auto it = table.find(member.value);
+    if (it == table.end()) {
+        table.emplace(member, [&](auto& row) {
+            row.member = member;
+            row.key = key;
+        });
+    }
+    else {
+        // The nonce carries over, so ballots signed with a replaced key can't be replayed under the new one either
+        table.modify(it, member, [&](auto& row) { row.key = key; });
+    }
+}
+
+void fractal_contract::setchainid(const checksum256& chain_id)
+{
+    // Contracts can't read the chain id, so it is configured once per deployment
+    require_auth(get_self());
+
+    BallotConfigSingleton config(default_contract_account, default_contract_account.value);
+    config.set(BallotConfig{.chainId = chain_id}, get_self());
+}
+
+void fractal_contract::submitballots(const name& relayer, const std::vector<SignedBallot>& ballots)
+{
+    // The relayer authorizes the transaction and pays for the rows. Each ballot is authorized by its signer's
+    // ballot key instead, and otherwise counts like the signer's own submitcons.
+    require_auth(relayer);
+    check(!ballots.empty(), noSigners.data());
+    check(ballots.size() <= max_ballot_batch, ballotBatchTooLarge.data());
+
+    ElectionCountSingleton singleton(default_contract_account, default_contract_account.value);
+    auto election = singleton.get_or_default(defaultElectionInf);
+    check(election.starttime + eleclimit > current_time_point(), electionEnded.data());
+
+    BallotConfigSingleton config(default_contract_account, default_contract_account.value);
+    check(config.exists(), noChainId.data());
+    auto chainId = config.get().chainId;
+
+    BallotKeysTable keys(default_contract_account, default_contract_account.value);
+    for (const auto& signedBallot : ballots) {
+        const auto& ballot = signedBallot.ballot;
+        check(ballot.electionNr == election.electionNr, wrongElection.data());
+        check(ballot.groupnr >= 1 && round_of(ballot.groupnr) <= max_round, "Group number error.");
+
+        auto key = keys.find(ballot.signer.value);
+        check(key != keys.end(), noBallotKey.data());
+        check(ballot.nonce > key->lastNonce, staleNonce.data());
+        check(recover_key(eden_fractal::ballots::digest(chainId, get_self(), ballot), signedBallot.signature) == key->key, invalidBallotSignature.data());
+        keys.modify(key, same_payer, [&](auto& row) { row.lastNonce = ballot.nonce; });
+
+        validate_ranking(ballot.ranking);
+        record_submission(election.electionNr, ballot.groupnr, ballot.ranking, ballot.signer, relayer);
     }
 }
 
@@ -325,6 +1162,327 @@ void fractal_contract::startelect()
     singleton.set(liza, get_self());
 }
 
+/*** Schema migration ***/
+
+void fractal_contract::migrate(const name& table, uint32_t max_rows)
+{
+    require_auth(get_self());
+    check(max_rows > 0, "max_rows must be positive");
+
+    if (table == "rewardconf"_n) {
+        set_reward_config(get_reward_config());
+    }
+    else if (table == "signatures"_n) {
+        migrate_signatures(max_rows);
+    }
+    else if (table == "holders"_n) {
+        index_holders(max_rows);
+    }
+    else {
+        check(false, unknownTable.data());
+    }
+}
+
+void fractal_contract::migrate_signatures(uint32_t max_rows)
+{
+    // First move the rows of the unversioned legacy table, then bring rows of older layouts up to date.
+    // The signers don't authorize the migration, so the contract pays for every moved row.
+    LegacySignersTable legacy(default_contract_account, default_contract_account.value);
+    SignersTable table(default_contract_account, default_contract_account.value);
+
+    uint32_t rows = 0;
+    for (auto it = legacy.begin(); it != legacy.end() && rows < max_rows; ++rows) {
+        auto signer = it->signer;
+        it = legacy.erase(it);
+        table.emplace(get_self(), [&](auto& row) { row.value = Signature{.signer = signer}; });
+    }
+
+    if (rows < max_rows) {
+        MigrationsTable migrations(default_contract_account, default_contract_account.value);
+        auto cursor = migrations.find("signatures"_n.value);
+        auto next = (cursor == migrations.end()) ? uint64_t{0} : cursor->cursor;
+
+        upgrade_rows(table, next, max_rows - rows);
+
+        if (cursor == migrations.end()) {
+            migrations.emplace(get_self(), [&](auto& row) {
+                row.table = "signatures"_n;
+                row.cursor = next;
+            });
+        }
+        else {
+            migrations.modify(cursor, same_payer, [&](auto& row) { row.cursor = next; });
+        }
+    }
+}
+
+void fractal_contract::index_holders(uint32_t max_rows)
+{
+    // Balances from before the holders index existed. Contracts can't enumerate the `accounts` scopes,
+    // so the backfill visits every member who was ever ranked, which covers all EDEN issued by distributions.
+    MigrationsTable migrations(default_contract_account, default_contract_account.value);
+    auto cursor = migrations.find("holders"_n.value);
+    auto next = (cursor == migrations.end()) ? uint64_t{0} : cursor->cursor;
+
+    MembersTable members(default_contract_account, default_contract_account.value);
+    uint32_t rows = 0;
+    int64_t indexed = 0;
+    auto it = members.lower_bound(next);
+    for (; it != members.end() && rows < max_rows; ++it, ++rows) {
+        accounts balances(get_self(), it->member.value);
+        auto balance = balances.find(eden_symbol.code().raw());
+        if (balance != balances.end() && balance->balance.amount != 0) {
+            indexed += update_holder_index(it->member, true);
+        }
+        next = it->id + 1;
+    }
+    if (indexed != 0) {
+        update_global_stats(indexed);
+    }
+    if (it == members.end()) {
+        next = 0;
+    }
+
+    if (cursor == migrations.end()) {
+        migrations.emplace(get_self(), [&](auto& row) {
+            row.table = "holders"_n;
+            row.cursor = next;
+        });
+    }
+    else {
+        migrations.modify(cursor, same_payer, [&](auto& row) { row.cursor = next; });
+    }
+}
+
+/*** Group formation related ***/
+
+void fractal_contract::checkin(const name& member)
+{
+    require_auth(member);
+
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    auto election = electionSingleton.get_or_default(defaultElectionInf);
+    check(election.starttime + eleclimit > current_time_point(), electionEnded.data());
+
+    check(has_signed(member), checkinRequiresSignature.data());
+
+    GroupFormationSingleton formSingleton(default_contract_account, default_contract_account.value);
+    auto formation = get_formation(formSingleton, election.electionNr);
+    check(formation.stage == GroupFormation::open, checkinClosed.data());
+    // The seed is fixed before anyone checks in, so it cannot be chosen to suit the checked-in members
+    check(formation.seedHash != checksum256{}, checkinBeforeSeed.data());
+
+    CheckinTable table(default_contract_account, election.electionNr);
+    check(table.find(member.value) == table.end(), alreadyCheckedIn.data());
+    table.emplace(member, [&](auto& row) {
+        row.member = member;
+        row.shuffleKey = 0;
+    });
+
+    formation.numCheckedIn += 1;
+    formSingleton.set(formation, get_self());
+}
+
+void fractal_contract::commitseed(const checksum256& seedhash)
+{
+    require_admin_auth();
+
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    auto election = electionSingleton.get_or_default(defaultElectionInf);
+    check(election.electionNr > 0, noElections.data());
+
+    GroupFormationSingleton formSingleton(default_contract_account, default_contract_account.value);
+    auto formation = get_formation(formSingleton, election.electionNr);
+    check(formation.stage == GroupFormation::open, checkinClosed.data());
+    check(formation.seedHash == checksum256{}, seedAlreadyCommitted.data());
+
+    formation.seedHash = seedhash;
+    formSingleton.set(formation, get_self());
+}
+
+void fractal_contract::formgroups(const checksum256& seed, uint32_t max_steps)
+{
+    // Runs in up to `max_steps` row operations per call, and resumes where the previous call stopped:
+    //   keying:    stamps every check-in with its shuffle key
+    //   assigning: walks check-ins in shuffle order and appends them to balanced rosters
+    require_admin_auth();
+    check(max_steps > 0, "max_steps must be positive");
+
+    ElectionCountSingleton electionSingleton(default_contract_account, default_contract_account.value);
+    auto election = electionSingleton.get_or_default(defaultElectionInf);
+
+    GroupFormationSingleton formSingleton(default_contract_account, default_contract_account.value);
+    auto formation = get_formation(formSingleton, election.electionNr);
+    check(formation.seedHash != checksum256{}, noSeedCommitted.data());
+    check(formation.stage != GroupFormation::done, groupsAlreadyFormed.data());
+
+    auto seedBytes = seed.extract_as_byte_array();
+    check(sha256(reinterpret_cast<const char*>(seedBytes.data()), seedBytes.size()) == formation.seedHash, seedMismatch.data());
+
+    auto tables = get_reward_tables();
+    if (formation.stage == GroupFormation::open) {
+        check(formation.numCheckedIn > 0, cannotFormGroups.data());
+        auto numGroups = num_groups(formation.numCheckedIn, tables.max_group_size);
+        check(numGroups >= tables.min_groups, too_few_groups.data());
+        check(formation.numCheckedIn / numGroups >= tables.min_group_size, cannotFormGroups.data());
+
+        formation.stage = GroupFormation::keying;
+        formation.numProcessed = 0;
+    }
+
+    CheckinTable checkins(get_self(), election.electionNr);
+    uint32_t steps = 0;
+
+    if (formation.stage == GroupFormation::keying) {
+        auto it = (formation.numProcessed == 0) ? checkins.begin() : checkins.upper_bound(formation.cursorMember.value);
+        for (; it != checkins.end() && steps < max_steps; ++it, ++steps) {
+            checkins.modify(it, same_payer, [&](auto& row) { row.shuffleKey = shuffle_key(seedBytes, election.electionNr, row.member); });
+            formation.cursorMember = it->member;
+            ++formation.numProcessed;
+        }
+
+        if (it == checkins.end()) {
+            formation.stage = GroupFormation::assigning;
+            formation.numProcessed = 0;
+            formation.cursorKey = 0;
+        }
+    }
+
+    if (formation.stage == GroupFormation::assigning) {
+        auto byShuffle = checkins.get_index<"byshuffle"_n>();
+        auto it = byShuffle.lower_bound(formation.cursorKey);
+        if (formation.numProcessed > 0) {
+            // Rows with equal shuffle keys are ordered by member, skip the ones already assigned
+            while (it != byShuffle.end() && it->shuffleKey == formation.cursorKey && it->member.value <= formation.cursorMember.value) {
+                ++it;
+            }
+        }
+
+        RosterTable rosters(get_self(), election.electionNr);
+        auto numGroups = num_groups(formation.numCheckedIn, tables.max_group_size);
+
+        // Consecutive members land in the same group, so each roster is written once per call
+        uint64_t batchGroup = 0;
+        std::vector<name> batch;
+        auto flushBatch = [&]() {
+            if (batch.empty()) {
+                return;
+            }
+            append_to_roster(rosters, batchGroup, batch);
+            batch.clear();
+        };
+
+        for (; it != byShuffle.end() && steps < max_steps; ++it, ++steps) {
+            auto groupNr = group_of(formation.numProcessed, formation.numCheckedIn, numGroups) + 1;
+            if (groupNr != batchGroup) {
+                flushBatch();
+                batchGroup = groupNr;
+            }
+            batch.push_back(it->member);
+
+            formation.cursorKey = it->shuffleKey;
+            formation.cursorMember = it->member;
+            ++formation.numProcessed;
+        }
+        flushBatch();
+
+        if (formation.numProcessed == formation.numCheckedIn) {
+            formation.stage = GroupFormation::done;
+        }
+    }
+
+    formSingleton.set(formation, get_self());
+}
+
+void fractal_contract::advanceround(uint8_t promote, uint32_t max_steps)
+{
+    // Forms the next round of the current election in up to `max_steps` row operations per call, and resumes where
+    // the previous call stopped, so a round costs O(rooms of that round) steps however large the election is:
+    //   promoting: visits the rooms of the current round in group order and queues the top `promote` members of each
+    //   assigning: deals the queued members into balanced rosters of the next round
+    // A room's ranking is its consensus (see get_room_consensus). Rooms without a ranking of their roster promote nobody.
+    require_admin_auth();
+    check(max_steps > 0, "max_steps must be positive");
+
+    auto round = get_election_round();
+    auto electionNr = round.electionNr;
+
+    GroupFormationSingleton formSingleton(default_contract_account, default_contract_account.value);
+    check(get_formation(formSingleton, electionNr).stage == GroupFormation::done, groupsNotFormed.data());
+
+    auto tables = get_reward_tables();
+    if (round.stage == ElectionRound::ranking) {
+        check(promote >= 1 && promote < tables.max_group_size, invalidPromote.data());
+        check(round.round < max_round, tooManyRounds.data());
+
+        round.stage = ElectionRound::promoting;
+        round.promote = promote;
+        round.numPromoted = 0;
+        round.cursorGroup = round_group(round.round, 1);
+    }
+
+    RosterTable rosters(get_self(), electionNr);
+    PromotionsTable promotions(get_self(), electionNr);
+    uint32_t steps = 0;
+
+    if (round.stage == ElectionRound::promoting) {
+        auto end = rosters.lower_bound(round_group(round.round + 1, 0));
+        auto it = rosters.lower_bound(round.cursorGroup);
+        for (; it != end && steps < max_steps; ++it, ++steps) {
+            round.cursorGroup = it->groupNr + 1;
+
+            // Only rankings of the room's roster count. Rankings list the top-ranked member last.
+            auto ranking = get_room_consensus(electionNr, *it);
+            auto count = std::min<size_t>(round.promote, ranking.size());
+            for (auto member = ranking.rbegin(); member != ranking.rbegin() + count; ++member) {
+                promotions.emplace(get_self(), [&](auto& row) {
+                    row.position = round.numPromoted;
+                    row.member = *member;
+                });
+                ++round.numPromoted;
+            }
+        }
+
+        if (it == end) {
+            check(round.numPromoted > 0 && round.numPromoted / num_groups(round.numPromoted, tables.max_group_size) >= tables.min_group_size,
+                  cannotFormGroups.data());
+            round.stage = ElectionRound::assigning;
+            round.numProcessed = 0;
+        }
+    }
+
+    if (round.stage == ElectionRound::assigning) {
+        auto next = round.round + 1;
+        auto numGroups = num_groups(round.numPromoted, tables.max_group_size);
+
+        // Consecutive members land in the same group, so each roster is written once per call
+        uint64_t batchGroup = 0;
+        std::vector<name> batch;
+        for (auto it = promotions.begin(); it != promotions.end() && steps < max_steps; ++steps) {
+            auto groupNr = round_group(next, group_of(round.numProcessed, round.numPromoted, numGroups) + 1);
+            if (groupNr != batchGroup && !batch.empty()) {
+                append_to_roster(rosters, batchGroup, batch);
+                batch.clear();
+            }
+            batchGroup = groupNr;
+            batch.push_back(it->member);
+
+            it = promotions.erase(it);
+            ++round.numProcessed;
+        }
+        if (!batch.empty()) {
+            append_to_roster(rosters, batchGroup, batch);
+        }
+
+        if (round.numProcessed == round.numPromoted) {
+            round = ElectionRound{.electionNr = electionNr, .round = static_cast<uint8_t>(next), .stage = ElectionRound::ranking};
+        }
+    }
+
+    ElectionRoundSingleton roundSingleton(default_contract_account, default_contract_account.value);
+    roundSingleton.set(round, get_self());
+}
+
 void fractal_contract::sub_balance(const name& owner, const asset& value)
 {
     accounts from_acnts(get_self(), owner.value);
@@ -332,21 +1490,62 @@ void fractal_contract::sub_balance(const name& owner, const asset& value)
     const auto& from = from_acnts.get(value.symbol.code().raw(), "no balance object found");
     check(from.balance.amount >= value.amount, "overdrawn balance");
 
+    auto previous = from.balance.amount;
     from_acnts.modify(from, owner, [&](auto& a) { a.balance -= value; });
+    if (value.amount != 0 && owner != get_self()) {
+        checkpoint_balance(owner, previous, from.balance.amount, current_election());
+    }
+    if (from.balance.amount == 0) {
+        if (auto removed = update_holder_index(owner, false)) {
+            update_global_stats(removed);
+        }
+    }
 }
 
 void fractal_contract::add_balance(const name& owner, const asset& value, const name& ram_payer)
 {
     accounts to_acnts(get_self(), owner.value);
     auto to = to_acnts.find(value.symbol.code().raw());
+    auto previous = to != to_acnts.end() ? to->balance.amount : 0;
+    if (value.amount != 0 && owner != get_self()) {
+        checkpoint_balance(owner, previous, previous + value.amount, current_election());
+    }
     if (to == to_acnts.end()) {
         to_acnts.emplace(ram_payer, [&](auto& a) { a.balance = value; });
+        if (value.amount != 0) {
+            if (auto added = update_holder_index(owner, true)) {
+                update_global_stats(added);
+            }
+        }
     }
     else {
+        if (previous == 0 && value.amount != 0) {
+            if (auto added = update_holder_index(owner, true)) {
+                update_global_stats(added);
+            }
+        }
         to_acnts.modify(to, same_payer, [&](auto& a) { a.balance += value; });
     }
 }
 
+void fractal_contract::validate_ranking(const std::vector<name>& rankings)
+{
+    size_t group_size = rankings.size();
+
+    auto tables = get_reward_tables();
+    check(group_size >= tables.min_group_size, group_too_small.data());
+    check(group_size <= tables.max_group_size, group_too_large.data());
+
+    for (auto it = rankings.begin(); it != rankings.end(); ++it) {
+        if (!is_account(*it)) {
+            check(false, it->to_string() + " account does not exist.");
+        }
+        if (std::find(rankings.begin(), it, *it) != it) {
+            check(false, it->to_string() + " is ranked more than once.");
+        }
+    }
+}
+
 void fractal_contract::validate_symbol(const symbol& symbol)
 {
     check(symbol.value == eden_symbol.value, "invalid symbol");
@@ -370,21 +1569,83 @@ void fractal_contract::require_admin_auth()
     check(hasAuth, requiresAdmin.data());
 }
 
+#ifdef EDEN_FRACTAL_HEAP_STATS
+// Replaces the global allocation functions to count every C++ allocation of the contract.
+// A 16-byte header in front of each block records its size, so delete can track the live bytes.
+eden_fractal::heap_stats::Counters eden_fractal::heap_stats::counters{};
+
+void* operator new(size_t size)
+{
+    auto& stats = heap_stats::counters;
+    auto block = static_cast<char*>(malloc(size + 16));
+    check(block != nullptr, "out of memory");
+    *reinterpret_cast<size_t*>(block) = size;
+
+    stats.allocations += 1;
+    stats.allocatedBytes += size;
+    stats.liveBytes += size;
+    stats.peakLiveBytes = std::max(stats.peakLiveBytes, stats.liveBytes);
+    return block + 16;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr) {
+        auto block = static_cast<char*>(ptr) - 16;
+        heap_stats::counters.liveBytes -= *reinterpret_cast<size_t*>(block);
+        free(block);
+    }
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+#endif
+
 EOSIO_ACTION_DISPATCHER(eden_fractal::actions)
 
 // clang-format off
 EOSIO_ABIGEN(actions(eden_fractal::actions), 
     table("agreement"_n, eden_fractal::Agreement), 
-    table("signatures"_n, eden_fractal::Signature),
+    table("sigs"_n, eden_fractal::SignatureRow),
+    table("signatures"_n, eden_fractal::SignatureV0),
 
     table("accounts"_n, eden_fractal::account),
     table("stat"_n, eden_fractal::currency_stats),
+    table("holders"_n, eden_fractal::Holder),
+    table("checkpoints"_n, eden_fractal::BalanceCheckpoint),
+
+    table("rewardcfg"_n, eden_fractal::RewardConfigRow),
+    table("rewardconf"_n, eden_fractal::RewardConfigV0),
+    table("rewardtables"_n, eden_fractal::RewardTables),
+    table("decaytables"_n, eden_fractal::DecayTables),
+    table("respect"_n, eden_fractal::Respect),
+    table("distconf"_n, eden_fractal::DistribConfig),
 
-    table("rewardconf"_n, eden_fractal::RewardConfig),
+    table("migrations"_n, eden_fractal::MigrationCursor),
+
+    table("results"_n, eden_fractal::ElectionResults),
+    table("settlements"_n, eden_fractal::Settlement),
+    table("members"_n, eden_fractal::MemberId),
 
     table("consenzus"_n, eden_fractal::Consenzus),
+    table("groupcons"_n, eden_fractal::GroupConsensus),
+    table("cosigners"_n, eden_fractal::CoSigner),
+    table("ballotkeys"_n, eden_fractal::BallotKey),
+    table("ballotcfg"_n, eden_fractal::BallotConfig),
     table("electioninf"_n, eden_fractal::ElectionInf),
 
+    table("checkins"_n, eden_fractal::CheckIn),
+    table("rosters"_n, eden_fractal::Roster),
+    table("groupform"_n, eden_fractal::GroupFormation),
+    table("electround"_n, eden_fractal::ElectionRound),
+    table("promotions"_n, eden_fractal::Promotion),
+
+    table("globalstats"_n, eden_fractal::GlobalStats),
+    table("electstats"_n, eden_fractal::ElectionStats),
+    table("attendance"_n, eden_fractal::Attendance),
+
 
 
 
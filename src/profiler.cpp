@@ -0,0 +1,158 @@
+#include <eosio/print.hpp>
+
+#include "profiler.hpp"
+
+// Linked into the debug contract when EDEN_FRACTAL_PROFILE is on, and compiled without the instrumentation
+// flags, so nothing in here is counted or hooked. See profiler.hpp.
+namespace {
+
+    constexpr uint32_t maxDepth = 32;     // Deeper frames are counted against their ancestor at this depth
+    constexpr uint32_t maxStacks = 2048;  // Distinct stacks; calls of further new stacks are counted as dropped
+    constexpr uint32_t hashSlots = 4096;  // Open-addressing index over the stacks, a power of 2
+    constexpr uint32_t noStack = ~0u;
+
+    struct Stack {
+        uint32_t frames[maxDepth];
+        uint32_t hash;
+        uint32_t depth;
+        uint64_t calls;
+        uint64_t inclusive;  // Ticks from entry to exit, summed over all calls
+        uint64_t exclusive;  // inclusive minus the ticks of the calls made from this stack
+    };
+
+    // An active call
+    struct Frame {
+        uint32_t fn;
+        uint32_t hash;  // Covers this frame and its callers
+        uint32_t stack;
+        uint64_t entered;
+        uint64_t childTicks;
+    };
+
+    struct State {
+        uint64_t ticks;
+        bool enabled;
+
+        Frame frames[maxDepth];
+        uint32_t depth;  // May exceed maxDepth
+
+        Stack stacks[maxStacks];
+        uint16_t slots[hashSlots];  // Stack index + 1, or 0 when free
+        uint32_t numStacks;
+        uint64_t dropped;
+    };
+    State state{};
+
+    // Finds or adds the stack made of frames[0..depth)
+    uint32_t find_stack(uint32_t depth, uint32_t hash)
+    {
+        for (auto slot = hash & (hashSlots - 1);; slot = (slot + 1) & (hashSlots - 1)) {
+            if (state.slots[slot] == 0) {
+                if (state.numStacks == maxStacks) {
+                    return noStack;
+                }
+                auto s = state.numStacks++;
+                auto& stack = state.stacks[s];
+                for (uint32_t i = 0; i < depth; ++i) {
+                    stack.frames[i] = state.frames[i].fn;
+                }
+                stack.hash = hash;
+                stack.depth = depth;
+                state.slots[slot] = s + 1;
+                return s;
+            }
+
+            auto s = state.slots[slot] - 1;
+            const auto& stack = state.stacks[s];
+            if (stack.hash != hash || stack.depth != depth) {
+                continue;
+            }
+            uint32_t i = 0;
+            while (i < depth && stack.frames[i] == state.frames[i].fn) {
+                ++i;
+            }
+            if (i == depth) {
+                return s;
+            }
+        }
+    }
+
+}  // namespace
+
+void eden_fractal::profiler::start()
+{
+    state.enabled = true;
+}
+
+void eden_fractal::profiler::finish()
+{
+    state.enabled = false;
+    for (uint32_t s = 0; s < state.numStacks; ++s) {
+        const auto& stack = state.stacks[s];
+        eosio::print("profile ");
+        for (uint32_t i = 0; i < stack.depth; ++i) {
+            eosio::print(i == 0 ? "" : ";", stack.frames[i]);
+        }
+        eosio::print(" ", stack.calls, " ", stack.inclusive, " ", stack.exclusive, "\n");
+    }
+    if (state.dropped) {
+        eosio::print("profile-dropped calls=", state.dropped, "\n");
+    }
+}
+
+// Called on every basic-block edge of the instrumented code
+extern "C" void __sanitizer_cov_trace_pc()
+{
+    ++state.ticks;
+}
+
+// Entry and exit hooks called by every function compiled with -finstrument-functions. `fn` is the function's
+// index in the wasm table, which tools/profile/symbolize.sh resolves from the debug wasm.
+extern "C" void __cyg_profile_func_enter(void* fn, void*)
+{
+    if (!state.enabled) {
+        return;
+    }
+    auto depth = state.depth++;
+    if (depth >= maxDepth) {
+        return;
+    }
+
+    auto& frame = state.frames[depth];
+    frame.fn = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(fn));
+    auto parent = depth > 0 ? state.frames[depth - 1].hash : 2166136261u;
+    frame.hash = (parent ^ frame.fn) * 16777619u;
+    frame.stack = find_stack(depth + 1, frame.hash);
+    frame.childTicks = 0;
+    if (frame.stack == noStack) {
+        ++state.dropped;
+    }
+    else {
+        ++state.stacks[frame.stack].calls;
+    }
+    frame.entered = state.ticks;
+}
+
+extern "C" void __cyg_profile_func_exit(void*, void*)
+{
+    // Functions entered before recording started, like the contract constructor, exit at depth 0
+    if (!state.enabled || state.depth == 0) {
+        return;
+    }
+    auto depth = --state.depth;
+    if (depth >= maxDepth) {
+        return;
+    }
+
+    const auto& frame = state.frames[depth];
+    auto inclusive = state.ticks - frame.entered;
+    if (frame.stack != noStack) {
+        auto& stack = state.stacks[frame.stack];
+        stack.inclusive += inclusive;
+        stack.exclusive += inclusive - frame.childTicks;
+    }
+    // The ticks of a dropped stack stay in its caller's exclusive ticks
+    if (depth > 0 && frame.stack != noStack) {
+        state.frames[depth - 1].childTicks += inclusive;
+    }
+}
@@ -2,6 +2,7 @@
 #include <token/token.hpp>
 
 #include "fractal-contract.hpp"
+#include "merkle.hpp"
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
@@ -45,6 +46,112 @@ namespace {
     constexpr auto code_permission = "eosio.code"_n;
     permission_level EdenFractalAuth{eden_fractal::default_contract_account, code_permission};
 
+    // Rooms per election in the season replay. Set by the EDEN_SEASON_ROOMS cmake cache variable
+#ifndef EDEN_SEASON_ROOMS
+#define EDEN_SEASON_ROOMS 10
+#endif
+    constexpr uint32_t seasonElections = 52;
+    constexpr uint32_t seasonRooms = EDEN_SEASON_ROOMS;
+    constexpr uint32_t roomSize = 6;
+
+    // Elapsed time of the first sign, submitcons or transfer on a freshly deployed contract, and of a second call.
+    // Set by the EDEN_COLD_START_BUDGET_US and EDEN_WARM_ACTION_BUDGET_US cmake cache variables
+#ifndef EDEN_COLD_START_BUDGET_US
+#define EDEN_COLD_START_BUDGET_US 100000
+#endif
+#ifndef EDEN_WARM_ACTION_BUDGET_US
+#define EDEN_WARM_ACTION_BUDGET_US 2000
+#endif
+    constexpr int64_t coldStartBudgetUs = EDEN_COLD_START_BUDGET_US;
+    constexpr int64_t warmActionBudgetUs = EDEN_WARM_ACTION_BUDGET_US;
+
+    // Memory budget of a distribution to this many groups, checked against the instrumented debug contract
+    constexpr uint32_t budgetGroups = 100;
+    constexpr uint64_t distributionHeapBudget = 2 * 1024 * 1024;
+
+    // Generated account names for large populations: "member" followed by 5 letters
+    name member_name(uint32_t index)
+    {
+        std::string str = "member";
+        for (int digit = 0; digit < 5; ++digit) {
+            str += static_cast<char>('a' + index % 26);
+            index /= 26;
+        }
+        return name{str};
+    }
+
+    // Resource usage of a batch of transactions
+    struct UsageReport {
+        uint64_t cpu_us = 0;
+        int64_t ram_bytes = 0;  // RAM billed to any account, members included
+        int64_t slowest_us = 0;
+        name slowest_action;
+
+        void add(const transaction_trace& trace)
+        {
+            cpu_us += trace.cpu_usage_us;
+            for (const auto& action : trace.action_traces) {
+                for (const auto& delta : action.account_ram_deltas) {
+                    ram_bytes += delta.delta;
+                }
+                if (action.receiver == eden_fractal::default_contract_account && action.elapsed > slowest_us) {
+                    slowest_us = action.elapsed;
+                    slowest_action = action.act.name;
+                }
+            }
+        }
+    };
+
+    // Heap usage printed by a debug contract built with EDEN_FRACTAL_HEAP_STATS (see heap_stats.hpp)
+    struct HeapReport {
+        unsigned allocations = 0;
+        unsigned long long bytes = 0;
+        unsigned long long peak = 0;
+        unsigned pages = 0;
+
+        static HeapReport of(const transaction_trace& trace, name action)
+        {
+            HeapReport report;
+            for (const auto& at : trace.action_traces) {
+                if (at.receiver == eden_fractal::default_contract_account && at.act.name == action) {
+                    auto line = at.console.find("heap allocs=");
+                    if (line != std::string::npos) {
+                        sscanf(at.console.c_str() + line, "heap allocs=%u bytes=%llu peak=%llu pages=%u", &report.allocations, &report.bytes,
+                               &report.peak, &report.pages);
+                    }
+                }
+            }
+            return report;
+        }
+    };
+
+    // Prints the call profiles of a debug contract built with EDEN_FRACTAL_PROFILE (see profiler.hpp) to stdout as
+    // "flame <action>;<fn>;<fn>... <exclusive ticks>" lines, for tools/profile/symbolize.sh. Returns the total
+    // exclusive ticks, which is the time the contract's own code spent in the traced actions.
+    uint64_t print_profile(const transaction_trace& trace)
+    {
+        uint64_t total = 0;
+        for (const auto& at : trace.action_traces) {
+            if (at.receiver != eden_fractal::default_contract_account) {
+                continue;
+            }
+            auto action = at.act.name.to_string();
+            for (size_t pos = at.console.find("profile "); pos != std::string::npos; pos = at.console.find("profile ", pos)) {
+                pos += 8;
+                auto line = at.console.substr(pos, at.console.find('\n', pos) - pos);
+
+                // "<stack> <calls> <inclusive> <exclusive>"
+                char stack[1024];
+                unsigned long long calls, inclusive, exclusive;
+                if (sscanf(line.c_str(), "%1023s %llu %llu %llu", stack, &calls, &inclusive, &exclusive) == 4) {
+                    printf("flame %s;%s %llu\n", action.c_str(), stack, exclusive);
+                    total += exclusive;
+                }
+            }
+        }
+        return total;
+    }
+
 }  // namespace
 
 bool succeeded(const transaction_trace& trace)
@@ -74,6 +181,12 @@ bool failedWith(const transaction_trace& trace, std::string_view err)
     return ret;
 }
 
+// Pushes a single action in its own transaction, signed with the default key of every authorizer
+transaction_trace pushAction(test_chain& t, action&& act)
+{
+    return t.push_transaction(t.make_transaction({std::move(act)}));
+}
+
 // Set up the token contract
 void setup_token(test_chain& t)
 {
@@ -95,14 +208,64 @@ void setup_installMyContract(test_chain& t)
     t.as(contract).act<actions::create>();
 }
 
+// The accounts created by setup_createAccounts
+const std::vector<name> standardMembers{"alice"_n, "dan"_n, "james"_n, "bob"_n, "charlie"_n, "david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "igor"_n, "jenny"_n};
+
 // Setup function to add some accounts to the chain
 void setup_createAccounts(test_chain& t)
 {
-    for (auto user : {"alice"_n, "dan"_n, "james"_n, "bob"_n, "charlie"_n, "david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "igor"_n, "jenny"_n}) {
+    for (auto user : standardMembers) {
         t.create_account(user);
     }
 }
 
+// Checks `members`, who must have signed the agreement, in to the current election and forms its groups
+// with a fixed seed. Returns the rosters of the election's first round in group order.
+std::vector<Roster> setup_formGroups(test_chain& t, const std::vector<name>& members)
+{
+    auto seed = util::from_json<checksum256>("\"935e9bfd8d5a0063a135925a263baf7a5b81f896e24fac6cf22a53c3f3e7e1da\"");
+    auto seedHash = util::from_json<checksum256>("\"40261e763e37343bb42b0aaaf0356f06d5299f4b2d74ad4007c883b22151301d\"");
+
+    t.as("dan"_n).act<actions::commitseed>(seedHash);
+    for (auto member : members) {
+        t.as(member).act<actions::checkin>(member);
+    }
+    t.as("dan"_n).act<actions::formgroups>(seed, 1000);
+
+    fractal_contract::RosterTable rosters(default_contract_account, fractal_contract::get_election_round().electionNr);
+    return {rosters.begin(), rosters.lower_bound(round_group(1, 0))};
+}
+
+// Sets an agreement and has every one of `members` sign it
+void setup_signAgreement(test_chain& t, const std::vector<name>& members)
+{
+    t.as(default_contract_account).act<actions::setagreement>("test");
+    for (auto member : members) {
+        t.as(member).act<actions::sign>(member);
+    }
+}
+
+// Setup function to add `count` generated accounts (see member_name) to the chain
+std::vector<name> setup_createMembers(test_chain& t, uint32_t count)
+{
+    std::vector<name> members;
+    for (uint32_t i = 0; i < count; ++i) {
+        members.push_back(member_name(i));
+        t.create_account(members.back());
+        if (i % 100 == 99) {
+            t.start_block();
+        }
+    }
+    return members;
+}
+
+// Gives the eden fractal some EOS to distribute. Requires setup_token.
+void setup_fundContract(test_chain& t)
+{
+    t.as("eosio"_n).act<token::actions::issue>("eosio"_n, s2a("1000000.0000 EOS"), "");
+    t.as("eosio"_n).act<token::actions::transfer>("eosio"_n, default_contract_account, s2a("10000.0000 EOS"), "");
+}
+
 SCENARIO("Testing setagreement")
 {
     GIVEN("Standard chain setup")
@@ -208,6 +371,88 @@ SCENARIO("Testing sign and unsign")
     }
 }
 
+SCENARIO("Signature import")
+{
+    GIVEN("Standard chain setup with an agreement")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        self.act<actions::setagreement>("v1");
+
+        auto version_of = [](name signer) {
+            fractal_contract::SignersTable signers(default_contract_account, default_contract_account.value);
+            return latest(signers.get(signer.value).value).agreementVersion;
+        };
+
+        THEN("Alice cannot import signatures")
+        {
+            auto trace = t.as("alice"_n).trace<actions::importsigs>(vector<name>{"bob"_n}, 1);
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("Imports are limited in size")
+        {
+            auto trace = self.trace<actions::importsigs>(vector<name>(201, "bob"_n), 1);
+            CHECK(failedWith(trace, importBatchTooLarge));
+        }
+        THEN("Signatures of unpublished agreement versions cannot be imported")
+        {
+            auto trace = self.trace<actions::importsigs>(vector<name>{"bob"_n}, 2);
+            CHECK(failedWith(trace, unknownAgreementVersion));
+        }
+        WHEN("Signatures are imported, including one of a member who already signed")
+        {
+            t.as("alice"_n).act<actions::sign>("alice"_n);
+            auto trace = self.trace<actions::importsigs>(vector<name>{"alice"_n, "bob"_n, "charlie"_n}, 1);
+
+            THEN("The import succeeds and every member has signed version 1")
+            {
+                REQUIRE(succeeded(trace));
+                CHECK(version_of("alice"_n) == 1);
+                CHECK(version_of("bob"_n) == 1);
+                CHECK(version_of("charlie"_n) == 1);
+                CHECK(fractal_contract::get_stats().signers == 3);
+            }
+            THEN("Imported members cannot sign again")
+            {
+                CHECK(failedWith(t.as("bob"_n).trace<actions::sign>("bob"_n), alreadySigned));
+            }
+        }
+        WHEN("A new agreement version is set after the import, and only one member signs it")
+        {
+            self.act<actions::importsigs>(vector<name>{"alice"_n, "bob"_n}, 1);
+            self.act<actions::setagreement>("v2");
+            t.as("charlie"_n).act<actions::sign>("charlie"_n);
+
+            AND_WHEN("The outdated signatures are purged one row at a time")
+            {
+                for (int i = 0; i < 3; ++i) {
+                    t.start_block();
+                    CHECK(succeeded(self.trace<actions::purgesigs>(1)));
+                }
+
+                THEN("Only the signature of the current version is left")
+                {
+                    fractal_contract::SignersTable signers(default_contract_account, default_contract_account.value);
+                    std::vector<name> stored;
+                    for (const auto& row : signers) {
+                        stored.push_back(latest(row.value).signer);
+                    }
+                    CHECK(stored == std::vector<name>{"charlie"_n});
+                    CHECK(version_of("charlie"_n) == 2);
+                    CHECK(fractal_contract::get_stats().signers == 1);
+                }
+                THEN("Purged members can sign the new version")
+                {
+                    CHECK(succeeded(t.as("alice"_n).trace<actions::sign>("alice"_n)));
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("Testing token transfers")
 {
     GIVEN("Standard chain setup")
@@ -237,6 +482,91 @@ SCENARIO("Testing token transfers")
     }
 }
 
+SCENARIO("Batched token operations")
+{
+    GIVEN("The contract holds Eden tokens, and a cohort of new members")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+
+        auto contract = t.as(eden_fractal::default_contract_account);
+        contract.act<actions::issue>(eden_fractal::default_contract_account, s2a("1000.0000 EDEN"), "memo");
+
+        constexpr uint32_t cohortSize = 50;
+        auto members = setup_createMembers(t, cohortSize);
+        t.start_block();
+
+        std::vector<TokenTransfer> transfers;
+        for (auto member : members) {
+            transfers.push_back(TokenTransfer{member, s2a("1.0000 EDEN")});
+        }
+
+        THEN("Only the contract can send a batch")
+        {
+            auto trace = t.as("alice"_n).trace<actions::transfermany>("alice"_n, transfers, "memo", false);
+            CHECK(failedWith(trace, errors::untradeable));
+        }
+        THEN("An empty batch is rejected")
+        {
+            auto trace = contract.trace<actions::transfermany>(eden_fractal::default_contract_account, std::vector<TokenTransfer>{}, "memo", false);
+            CHECK(failedWith(trace, errors::noTransfers));
+        }
+        THEN("A batch larger than the sender's balance fails as a whole")
+        {
+            transfers.push_back(TokenTransfer{"alice"_n, s2a("999.0000 EDEN")});
+            CHECK(failed(contract.trace<actions::transfermany>(eden_fractal::default_contract_account, transfers, "memo", false)));
+            CHECK(fractal_contract::get_balance(eden_fractal::default_contract_account, eden_symbol.code()) == s2a("1000.0000 EDEN"));
+        }
+        THEN("openmany creates zero balances for every owner, once")
+        {
+            CHECK(succeeded(contract.trace<actions::openmany>(members, eden_fractal::default_contract_account)));
+            CHECK(fractal_contract::get_balance(members.back(), eden_symbol.code()) == s2a("0.0000 EDEN"));
+            CHECK(failed(contract.trace<actions::openmany>(std::vector<name>{members.front()}, eden_fractal::default_contract_account)));
+        }
+        WHEN("The cohort is paid with one transfermany")
+        {
+            auto batch = contract.trace<actions::transfermany>(eden_fractal::default_contract_account, transfers, "memo", false);
+            REQUIRE(succeeded(batch));
+
+            THEN("Every member is credited and the sender is debited once")
+            {
+                for (auto member : members) {
+                    CHECK(fractal_contract::get_balance(member, eden_symbol.code()) == s2a("1.0000 EDEN"));
+                }
+                CHECK(fractal_contract::get_balance(eden_fractal::default_contract_account, eden_symbol.code()) == s2a("950.0000 EDEN"));
+            }
+            THEN("Recipients were not notified")
+            {
+                CHECK(batch.action_traces.size() == 1);
+            }
+            THEN("It costs less CPU than one transfer per member")
+            {
+                uint64_t singlesCpu = 0;
+                for (auto member : members) {
+                    auto single = contract.trace<actions::transfer>(eden_fractal::default_contract_account, member, s2a("1.0000 EDEN"), "memo");
+                    REQUIRE(succeeded(single));
+                    singlesCpu += single.cpu_usage_us;
+                }
+                printf("%u recipients: transfermany %u us, single transfers %llu us\n", cohortSize, (unsigned)batch.cpu_usage_us, (unsigned long long)singlesCpu);
+
+                // Billed CPU is wall-clock time, so only check the batch against the sum of the singles
+                CHECK(batch.cpu_usage_us < singlesCpu);
+            }
+        }
+        WHEN("The cohort is paid with notifications")
+        {
+            auto batch = contract.trace<actions::transfermany>(eden_fractal::default_contract_account, transfers, "memo", true);
+            REQUIRE(succeeded(batch));
+
+            THEN("Every recipient is notified")
+            {
+                CHECK(batch.action_traces.size() == 1 + cohortSize);
+            }
+        }
+    }
+}
+
 SCENARIO("Rank submission")
 {
     GIVEN("Standard setup, and an admin has a ranking to submit")
@@ -246,6 +576,7 @@ SCENARIO("Rank submission")
         setup_installMyContract(t);
         setup_createAccounts(t);
         setup_token(t);
+        setup_fundContract(t);
 
         auto alice = t.as("alice"_n);
         auto self = t.as(eden_fractal::default_contract_account);
@@ -274,10 +605,6 @@ SCENARIO("Rank submission")
         "}";
         // clang-format on
 
-        // Give the eden fractal some EOS
-        t.as("eosio"_n).act<token::actions::issue>("eosio"_n, s2a("1000000.0000 EOS"), "");
-        t.as("eosio"_n).act<token::actions::transfer>("eosio"_n, default_contract_account, s2a("10000.0000 EOS"), "");
-
         THEN("Self may submit a ranking")
         {
             auto submitRanks = self.trace<actions::submitranks>(util::from_json<AllRankings>(ranks));
@@ -325,13 +652,10 @@ SCENARIO("Reward distribution")
         setup_installMyContract(t);
         setup_createAccounts(t);
         setup_token(t);
+        setup_fundContract(t);
 
         auto self = t.as(eden_fractal::default_contract_account);
 
-        // Give the eden fractal some EOS
-        t.as("eosio"_n).act<token::actions::issue>("eosio"_n, s2a("1000000.0000 EOS"), "");
-        t.as("eosio"_n).act<token::actions::transfer>("eosio"_n, default_contract_account, s2a("10000.0000 EOS"), "");
-
         AllRankings ranks{{{{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n}}, {{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n}}}};
 
         auto getJamesEden = []() {
@@ -430,6 +754,7 @@ SCENARIO("Setting reward and fib offset")
         setup_installMyContract(t);
         setup_createAccounts(t);
         setup_token(t);
+        setup_fundContract(t);
 
         auto alice = t.as("alice"_n);
         auto oldAdmin = t.as("dan"_n);
@@ -454,6 +779,105 @@ SCENARIO("Setting reward and fib offset")
     }
 }
 
+SCENARIO("Reward configuration")
+{
+    GIVEN("Standard setup")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        const vector<double> curve7{1, 2, 3, 4, 5, 6, 7};
+
+        THEN("Alice cannot change the reward config")
+        {
+            auto trace = t.as("alice"_n).trace<actions::setrewardcfg>(2, 4, 7, curve7);
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("Invalid group sizes are rejected")
+        {
+            CHECK(failedWith(self.trace<actions::setrewardcfg>(2, 7, 4, curve7), invalidGroupSizes));
+            CHECK(failedWith(self.trace<actions::setrewardcfg>(0, 4, 7, curve7), invalidGroupSizes));
+            CHECK(failedWith(self.trace<actions::setrewardcfg>(2, 4, 8, vector<double>(8, 1)), invalidGroupSizes));
+        }
+        THEN("The curve needs one positive weight per rank of the largest group")
+        {
+            CHECK(failedWith(self.trace<actions::setrewardcfg>(2, 4, 6, curve7), invalidCurve));
+            CHECK(failedWith(self.trace<actions::setrewardcfg>(2, 4, 7, vector<double>{1, 2, 3, 0, 5, 6, 7}), invalidCurve));
+        }
+        THEN("The fib offset cannot overflow the EDEN amount of the top rank")
+        {
+            CHECK(failedWith(self.trace<actions::fiboffset>(70), fibOffsetTooLarge));
+        }
+        WHEN("The config is migrated without changes")
+        {
+            self.act<actions::migrate>("rewardconf"_n, 1);
+
+            THEN("The stored tables hold the original curve")
+            {
+                fractal_contract::RewardTablesSingleton tables(default_contract_account, default_contract_account.value);
+                auto stored = tables.get();
+                CHECK(stored.min_groups == 2);
+                CHECK(stored.min_group_size == 5);
+                CHECK(stored.max_group_size == 6);
+                CHECK(stored.edenByRank == vector<int64_t>{50000, 80000, 130000, 210000, 340000, 550000});
+                CHECK(stored.eosWeights.size() == 6);
+            }
+        }
+        WHEN("Rooms of 4 to 7 members are configured")
+        {
+            REQUIRE(succeeded(self.trace<actions::setrewardcfg>(2, 4, 7, curve7)));
+            t.as("dan"_n).act<actions::startelect>();
+
+            THEN("Groups outside of the configured sizes are rejected")
+            {
+                const vector<name> group3{"james"_n, "dan"_n, "alice"_n};
+                const vector<name> group4{"bob"_n, "charlie"_n, "igor"_n, "david"_n};
+                auto trace = self.trace<actions::submitranks>(AllRankings{{GroupRanking{group3}, GroupRanking{group4}}});
+                CHECK(failedWith(trace, group_too_small));
+            }
+            AND_WHEN("A group of 7 and a group of 4 are ranked")
+            {
+                const vector<name> group7{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n, "david"_n};
+                const vector<name> group4{"elaine"_n, "frank"_n, "gary"_n, "harry"_n};
+                REQUIRE(succeeded(self.trace<actions::submitranks>(AllRankings{{GroupRanking{group7}, GroupRanking{group4}}})));
+
+                THEN("Both groups are paid from the top of the same curve")
+                {
+                    CHECK(fractal_contract::get_balance("james"_n, eden_symbol.code()) == s2a("5.0000 EDEN"));
+                    CHECK(fractal_contract::get_balance("david"_n, eden_symbol.code()) == s2a("89.0000 EDEN"));
+                    CHECK(fractal_contract::get_balance("elaine"_n, eden_symbol.code()) == s2a("21.0000 EDEN"));
+                    CHECK(fractal_contract::get_balance("harry"_n, eden_symbol.code()) == s2a("89.0000 EDEN"));
+                }
+            }
+            AND_WHEN("14 members are formed into rooms")
+            {
+                auto members = setup_createMembers(t, 14);
+                setup_signAgreement(t, members);
+                const auto rooms = setup_formGroups(t, members);
+
+                THEN("The consensus of a room of 7 is its Borda order")
+                {
+                    REQUIRE(rooms.size() == 2);
+                    const auto& room = rooms[0].members;
+                    REQUIRE(room.size() == 7);
+
+                    t.as(room[0]).act<actions::submitcons>(rooms[0].groupNr, room, room[0]);
+                    CHECK(fractal_contract::get_group_consensus(1, rooms[0].groupNr) == room);
+
+                    auto reversed = vector<name>(room.rbegin(), room.rend());
+                    t.as(room[1]).act<actions::submitcons>(rooms[0].groupNr, reversed, room[1]);
+                    t.as(room[2]).act<actions::submitcons>(rooms[0].groupNr, room, room[2]);
+                    CHECK(fractal_contract::get_group_consensus(1, rooms[0].groupNr) == room);
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("Testing start of an election")
 {
     GIVEN("Standard chain setup")
@@ -544,3 +968,1442 @@ SCENARIO("Consensus submission")
         }
     }
 }
+
+SCENARIO("Group formation")
+{
+    GIVEN("An election has started and most accounts signed the agreement")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        auto admin = t.as("dan"_n);
+
+        self.act<actions::setagreement>("test");
+        admin.act<actions::startelect>();
+
+        const std::vector<name> signers{"alice"_n, "dan"_n, "james"_n, "bob"_n, "charlie"_n, "david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "igor"_n};
+        for (auto signer : signers) {
+            t.as(signer).act<actions::sign>(signer);
+        }
+
+        auto seed = util::from_json<checksum256>("\"935e9bfd8d5a0063a135925a263baf7a5b81f896e24fac6cf22a53c3f3e7e1da\"");
+        auto seedHash = util::from_json<checksum256>("\"40261e763e37343bb42b0aaaf0356f06d5299f4b2d74ad4007c883b22151301d\"");
+
+        THEN("Jenny cannot check in without signing the agreement")
+        {
+            auto trace = t.as("jenny"_n).trace<actions::checkin>("jenny"_n);
+            CHECK(failedWith(trace, checkinRequiresSignature));
+        }
+        THEN("Alice cannot commit a seed")
+        {
+            auto trace = t.as("alice"_n).trace<actions::commitseed>(seedHash);
+            CHECK(failedWith(trace, requiresAdmin));
+        }
+        THEN("Nobody can check in before the seed is committed")
+        {
+            auto trace = t.as("alice"_n).trace<actions::checkin>("alice"_n);
+            CHECK(failedWith(trace, checkinBeforeSeed));
+        }
+        WHEN("The seed is committed and all signers check in")
+        {
+            admin.act<actions::commitseed>(seedHash);
+            for (auto signer : signers) {
+                t.as(signer).act<actions::checkin>(signer);
+            }
+
+            THEN("Alice cannot check in twice")
+            {
+                auto trace = t.as("alice"_n).trace<actions::checkin>("alice"_n);
+                CHECK(failedWith(trace, alreadyCheckedIn));
+            }
+            THEN("A second seed cannot be committed")
+            {
+                auto trace = admin.trace<actions::commitseed>(seed);
+                CHECK(failedWith(trace, seedAlreadyCommitted));
+            }
+            THEN("Groups cannot be formed with the wrong seed")
+            {
+                auto trace = admin.trace<actions::formgroups>(seedHash, 100);
+                CHECK(failedWith(trace, seedMismatch));
+            }
+            THEN("Groups are not formed when there are fewer than the configured minimum")
+            {
+                self.act<actions::setrewardcfg>(3, 5, 6, vector<double>{1, 2, 3, 4, 5, 6});
+                auto trace = admin.trace<actions::formgroups>(seed, 100);
+                CHECK(failedWith(trace, too_few_groups));
+            }
+            AND_WHEN("Groups are formed a few rows at a time")
+            {
+                auto getStage = []() {
+                    auto formSingleton = fractal_contract::GroupFormationSingleton(default_contract_account, default_contract_account.value);
+                    return formSingleton.get().stage;
+                };
+                for (int call = 0; call < 20 && getStage() != GroupFormation::done; ++call) {
+                    t.start_block();
+                    CHECK(succeeded(admin.trace<actions::formgroups>(seed, 3)));
+                }
+
+                THEN("Every checked-in member is in exactly one of two balanced groups")
+                {
+                    REQUIRE(getStage() == GroupFormation::done);
+
+                    fractal_contract::RosterTable rosters(default_contract_account, 1);
+                    std::vector<size_t> sizes;
+                    std::vector<name> assigned;
+                    for (const auto& roster : rosters) {
+                        sizes.push_back(roster.members.size());
+                        assigned.insert(assigned.end(), roster.members.begin(), roster.members.end());
+                    }
+                    CHECK(sizes == std::vector<size_t>{6, 5});
+
+                    auto expected = signers;
+                    std::sort(expected.begin(), expected.end());
+                    std::sort(assigned.begin(), assigned.end());
+                    CHECK(assigned == expected);
+                }
+                THEN("Late members cannot check in anymore")
+                {
+                    t.as("jenny"_n).act<actions::sign>("jenny"_n);
+                    auto trace = t.as("jenny"_n).trace<actions::checkin>("jenny"_n);
+                    CHECK(failedWith(trace, checkinClosed));
+                }
+                THEN("Groups cannot be formed twice")
+                {
+                    auto trace = admin.trace<actions::formgroups>(seed, 100);
+                    CHECK(failedWith(trace, groupsAlreadyFormed));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Multi-round elections")
+{
+    GIVEN("30 checked-in members have been formed into the five rooms of round 0")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        auto admin = t.as("dan"_n);
+        admin.act<actions::startelect>();
+
+        auto members = setup_createMembers(t, 30);
+        setup_signAgreement(t, members);
+        const auto rooms = setup_formGroups(t, members);
+        REQUIRE(rooms.size() == 5);
+        fractal_contract::RosterTable rosters(default_contract_account, 1);
+
+        auto submitRooms = [&](size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                auto submitter = rooms[i].members.front();
+                t.as(submitter).act<actions::submitcons>(rooms[i].groupNr, rooms[i].members, submitter);
+            }
+        };
+        // Calls advanceround until the next round is formed, and returns the trace of the last call
+        auto advance = [&](uint8_t promote) {
+            transaction_trace trace;
+            auto round = fractal_contract::get_election_round().round;
+            for (int call = 0; call < 20 && fractal_contract::get_election_round().round == round; ++call) {
+                t.start_block();
+                trace = admin.trace<actions::advanceround>(promote, 2);
+                if (trace.except) {
+                    break;
+                }
+            }
+            return trace;
+        };
+
+        THEN("Alice cannot advance the round")
+        {
+            auto trace = t.as("alice"_n).trace<actions::advanceround>(1, 100);
+            CHECK(failedWith(trace, requiresAdmin));
+        }
+        THEN("Every room must promote someone")
+        {
+            auto trace = admin.trace<actions::advanceround>(0, 100);
+            CHECK(failedWith(trace, invalidPromote));
+        }
+        THEN("A single reporting room cannot fill another round")
+        {
+            submitRooms(1);
+            CHECK(failedWith(advance(1), cannotFormGroups));
+        }
+        THEN("Rankings that add outsiders to a room neither promote them nor block the round")
+        {
+            submitRooms(rooms.size());
+
+            auto intruded = rooms[0].members;
+            auto outsider = rooms[1].members.front();
+            intruded.back() = outsider;
+            auto submitter = rooms[1].members[1];
+            t.as(submitter).act<actions::submitcons>(rooms[0].groupNr, intruded, submitter);
+            REQUIRE(succeeded(advance(1)));
+
+            auto roster = rosters.find(round_group(1, 1));
+            REQUIRE(roster != rosters.end());
+            CHECK(roster->members.front() == rooms[0].members.back());
+        }
+        WHEN("Every room reports and the top member of each room is promoted a few rows at a time")
+        {
+            submitRooms(rooms.size());
+            REQUIRE(succeeded(advance(1)));
+
+            std::vector<name> winners;
+            for (const auto& room : rooms) {
+                winners.push_back(room.members.back());
+            }
+
+            THEN("The room winners form the single room of round 1")
+            {
+                REQUIRE(fractal_contract::get_election_round().round == 1);
+
+                auto roster = rosters.find(round_group(1, 1));
+                REQUIRE(roster != rosters.end());
+                CHECK(roster->members == winners);
+                CHECK(rosters.find(round_group(1, 2)) == rosters.end());
+
+                fractal_contract::PromotionsTable promotions(default_contract_account, 1);
+                CHECK(promotions.begin() == promotions.end());
+            }
+            THEN("Winners submit again for round 1, and only round 0 is rewarded")
+            {
+                auto submitter = winners.front();
+                CHECK(succeeded(t.as(submitter).trace<actions::submitcons>(round_group(1, 1), winners, submitter)));
+                CHECK(fractal_contract::get_group_consensus(1, round_group(1, 1)) == winners);
+
+                CHECK(succeeded(self.trace<actions::distribcons>()));
+                CHECK(fractal_contract::get_respect(winners.front(), 1, 1).elections == 1);
+            }
+            THEN("A made-up group of the next round is ignored")
+            {
+                // The 6 generated members after the 30 in the rooms
+                std::vector<name> outsiders;
+                for (uint32_t i = 30; i < 36; ++i) {
+                    outsiders.push_back(member_name(i));
+                    t.create_account(outsiders.back());
+                }
+                t.as(outsiders[0]).act<actions::submitcons>(round_group(1, 2), outsiders, outsiders[0]);
+                CHECK(failedWith(t.as(outsiders[0]).trace<actions::consensusof>(round_group(1, 2)), noRoster));
+            }
+            THEN("One room cannot promote into a further round")
+            {
+                auto submitter = winners.front();
+                t.as(submitter).act<actions::submitcons>(round_group(1, 1), winners, submitter);
+                CHECK(failedWith(advance(1), cannotFormGroups));
+            }
+        }
+    }
+}
+
+SCENARIO("Group consensus submission")
+{
+    GIVEN("An election has started and a room agrees on a ranking")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+
+        t.as("dan"_n).act<actions::startelect>();
+
+        const uint64_t electionNr = 1;
+        const uint64_t groupnr = 1;
+        const vector<name> ranking{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n};
+
+        auto submitGroup = [&](const vector<name>& signers, uint64_t room = groupnr) {
+            std::vector<permission_level> auths;
+            for (auto signer : signers) {
+                auths.push_back({signer, "active"_n});
+            }
+            return pushAction(t, actions::submitgroup{default_contract_account, std::move(auths)}.to_action(electionNr, room, ranking, signers));
+        };
+        auto groupRows = []() {
+            fractal_contract::GroupConsensusTable table(default_contract_account, 1);
+            return std::vector<GroupConsensus>(table.begin(), table.end());
+        };
+
+        THEN("The whole room may submit in one transaction")
+        {
+            CHECK(succeeded(submitGroup(ranking)));
+
+            auto rows = groupRows();
+            REQUIRE(rows.size() == 1);
+            CHECK(rows[0].rankings == ranking);
+            CHECK(rows[0].signerMask == 0b111111);
+        }
+        THEN("A signer outside of the ranked group cannot co-sign")
+        {
+            CHECK(failedWith(submitGroup({"james"_n, "david"_n}), signerNotInGroup));
+        }
+        THEN("A signer cannot authorize for someone else")
+        {
+            auto trace = t.as("james"_n).trace<actions::submitgroup>(electionNr, groupnr, ranking, vector<name>{"james"_n, "dan"_n});
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("A submission for another election is rejected")
+        {
+            auto trace = t.as("james"_n).trace<actions::submitgroup>(electionNr + 1, groupnr, ranking, vector<name>{"james"_n});
+            CHECK(failedWith(trace, wrongElection));
+        }
+        WHEN("Half of the room submits")
+        {
+            REQUIRE(succeeded(submitGroup({"james"_n, "dan"_n, "alice"_n})));
+
+            THEN("The other half joins the same ranking row")
+            {
+                CHECK(succeeded(submitGroup({"bob"_n, "charlie"_n, "igor"_n})));
+
+                auto rows = groupRows();
+                REQUIRE(rows.size() == 1);
+                CHECK(rows[0].signerMask == 0b111111);
+            }
+            THEN("A co-signer cannot submit again")
+            {
+                t.start_block();
+                CHECK(failedWith(submitGroup({"james"_n}), alreadySubmitted));
+
+                auto trace = t.as("james"_n).trace<actions::submitcons>(groupnr, ranking, "james"_n);
+                CHECK(failedWith(trace, alreadySubmitted));
+            }
+            THEN("A co-signer cannot vote again in another room")
+            {
+                CHECK(failedWith(submitGroup({"james"_n}, groupnr + 1), alreadySubmitted));
+
+                auto trace = t.as("dan"_n).trace<actions::submitcons>(groupnr + 1, ranking, "dan"_n);
+                CHECK(failedWith(trace, alreadySubmitted));
+            }
+        }
+        WHEN("Bob submitted on his own")
+        {
+            t.as("bob"_n).act<actions::submitcons>(groupnr, ranking, "bob"_n);
+
+            THEN("Bob cannot co-sign the room submission")
+            {
+                CHECK(failedWith(submitGroup(ranking), alreadySubmitted));
+            }
+            THEN("Bob cannot co-sign for another room either")
+            {
+                CHECK(failedWith(submitGroup({"bob"_n}, groupnr + 1), alreadySubmitted));
+            }
+        }
+    }
+}
+
+SCENARIO("Signed ballot submission")
+{
+    GIVEN("An election has started and a room registered its ballot keys")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+
+        t.as("dan"_n).act<actions::startelect>();
+        setup_signAgreement(t, standardMembers);
+        auto rooms = setup_formGroups(t, standardMembers);
+        REQUIRE(rooms.size() == 2);
+
+        const uint64_t electionNr = 1;
+        const uint64_t groupnr = rooms[0].groupNr;
+        const vector<name> ranking = rooms[0].members;
+        const name first = ranking.front();
+        const name outsider = rooms[1].members.front();
+        for (auto member : ranking) {
+            t.as(member).act<actions::setballotkey>(member, test_chain::default_pub_key);
+        }
+
+        auto chainId = util::from_json<checksum256>("\"aca376f206b8fc25a6ed44dbdc66547c36c6c33e3a119ffbeaef943642f0e906\"");
+        auto otherChainId = util::from_json<checksum256>("\"73e4385a2708e6d7048834fbc1079f2fabb17b3c125b146af438971e90716c4d\"");
+
+        auto signBallotFor = [&](const checksum256& chain, name signer, uint64_t nonce) {
+            auto ballot = Ballot{.signer = signer, .electionNr = electionNr, .groupnr = groupnr, .ranking = ranking, .nonce = nonce};
+            return SignedBallot{.ballot = ballot, .signature = sign(test_chain::default_priv_key, ballots::digest(chain, default_contract_account, ballot))};
+        };
+        auto signBallot = [&](name signer, uint64_t nonce) { return signBallotFor(chainId, signer, nonce); };
+        auto relay = [&](const vector<SignedBallot>& ballots) { return t.as("jenny"_n).trace<actions::submitballots>("jenny"_n, ballots); };
+
+        THEN("Ballots cannot be relayed before the chain id is set")
+        {
+            CHECK(failedWith(relay({signBallot(first, 1)}), noChainId));
+        }
+        THEN("Alice cannot set the chain id")
+        {
+            CHECK(failedWith(t.as("alice"_n).trace<actions::setchainid>(chainId), missingRequiredAuth));
+        }
+
+        t.as(default_contract_account).act<actions::setchainid>(chainId);
+
+        THEN("A relayer submits the whole room in one transaction")
+        {
+            vector<SignedBallot> ballots;
+            for (auto member : ranking) {
+                ballots.push_back(signBallot(member, 1));
+            }
+            CHECK(succeeded(relay(ballots)));
+
+            fractal_contract::ConsenzusTable table(default_contract_account, electionNr);
+            CHECK(std::distance(table.begin(), table.end()) == 6);
+            CHECK(fractal_contract::get_group_consensus(electionNr, groupnr) == ranking);
+            CHECK(fractal_contract::get_attendance(ranking.back()).lastElection == electionNr);
+        }
+        THEN("A ballot that was changed after signing is rejected")
+        {
+            auto ballot = signBallot(first, 1);
+            std::swap(ballot.ballot.ranking[0], ballot.ballot.ranking[1]);
+            CHECK(failedWith(relay({ballot}), invalidBallotSignature));
+        }
+        THEN("A ballot signed for another chain is rejected")
+        {
+            CHECK(failedWith(relay({signBallotFor(otherChainId, first, 1)}), invalidBallotSignature));
+        }
+        THEN("A member without a ballot key cannot be relayed")
+        {
+            CHECK(failedWith(relay({signBallot(outsider, 1)}), noBallotKey));
+        }
+        THEN("A ballot for another election is rejected")
+        {
+            auto ballot = signBallot(first, 1);
+            ballot.ballot.electionNr = electionNr + 1;
+            CHECK(failedWith(relay({ballot}), wrongElection));
+        }
+        WHEN("The first member's ballot was relayed")
+        {
+            REQUIRE(succeeded(relay({signBallot(first, 1)})));
+
+            THEN("It cannot be replayed")
+            {
+                t.start_block();
+                CHECK(failedWith(relay({signBallot(first, 1)}), staleNonce));
+            }
+            THEN("They cannot also submit on their own")
+            {
+                auto trace = t.as(first).trace<actions::submitcons>(groupnr, ranking, first);
+                CHECK(failedWith(trace, alreadySubmitted));
+            }
+        }
+    }
+}
+
+SCENARIO("Consensus solver")
+{
+    GIVEN("An election where the rooms submitted rankings that don't fully agree")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        t.as("dan"_n).act<actions::startelect>();
+        setup_signAgreement(t, standardMembers);
+        auto rooms = setup_formGroups(t, standardMembers);
+        REQUIRE(rooms.size() == 2);
+
+        const vector<name> majority = rooms[0].members;
+        const vector<name> minority{majority[1], majority[0], majority[2], majority[3], majority[4], majority[5]};
+        const vector<name> room2 = rooms[1].members;
+        const uint64_t group1 = rooms[0].groupNr;
+        const uint64_t group2 = rooms[1].groupNr;
+
+        for (size_t i = 2; i < majority.size(); ++i) {
+            t.as(majority[i]).act<actions::submitcons>(group1, majority, majority[i]);
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            t.as(majority[i]).act<actions::submitcons>(group1, minority, majority[i]);
+        }
+        t.as(room2[0]).act<actions::submitcons>(group2, room2, room2[0]);
+
+        THEN("The consensus of each room is the ranking closest to its submissions")
+        {
+            CHECK(fractal_contract::get_group_consensus(1, group1) == majority);
+            CHECK(fractal_contract::get_group_consensus(1, group2) == room2);
+        }
+        THEN("A co-signed ranking counts once per signer")
+        {
+            t.as(room2[1]).act<actions::submitcons>(group2, room2, room2[1]);
+            auto reversed = vector<name>(room2.rbegin(), room2.rend());
+            auto signers = vector<name>{room2[2], room2[3], room2[4]};
+            std::vector<permission_level> auths;
+            for (auto signer : signers) {
+                auths.push_back({signer, "active"_n});
+            }
+            REQUIRE(succeeded(pushAction(t, actions::submitgroup{default_contract_account, std::move(auths)}.to_action(1, group2, reversed, signers))));
+            CHECK(fractal_contract::get_group_consensus(1, group2) == reversed);
+        }
+        THEN("A group that was not formed has no consensus")
+        {
+            CHECK(failedWith(self.trace<actions::consensusof>(3), noRoster));
+        }
+        THEN("Submissions that don't rank the room's roster are ignored")
+        {
+            auto otherMembers = majority;
+            otherMembers[0] = room2[5];
+            t.as(room2[5]).act<actions::submitcons>(group1, otherMembers, room2[5]);
+            CHECK(fractal_contract::get_group_consensus(1, group1) == majority);
+            CHECK(succeeded(self.trace<actions::distribcons>()));
+        }
+        THEN("A made-up group is not rewarded")
+        {
+            const vector<name> puppets{"puppet1"_n, "puppet2"_n, "puppet3"_n, "puppet4"_n, "puppet5"_n};
+            for (auto puppet : puppets) {
+                t.create_account(puppet);
+            }
+            t.as(puppets[0]).act<actions::submitcons>(7, puppets, puppets[0]);
+
+            REQUIRE(succeeded(self.trace<actions::distribcons>()));
+            CHECK(fractal_contract::get_respect(puppets[0], 1, 1).elections == 0);
+        }
+        WHEN("The contract distributes from the consensus")
+        {
+            auto trace = self.trace<actions::distribcons>();
+            REQUIRE(succeeded(trace));
+
+            THEN("Rewards follow the solved rankings")
+            {
+                CHECK(fractal_contract::get_balance(majority[0], eden_symbol.code()) == s2a("5.0000 EDEN"));
+                CHECK(fractal_contract::get_balance(room2[0], eden_symbol.code()) == s2a("5.0000 EDEN"));
+                CHECK(fractal_contract::get_balance(majority[1], eden_symbol.code()) == fractal_contract::get_balance(room2[1], eden_symbol.code()));
+            }
+            THEN("The election cannot be distributed again")
+            {
+                t.start_block();
+                CHECK(failedWith(self.trace<actions::distribcons>(), alreadyDistributed));
+            }
+        }
+    }
+}
+
+SCENARIO("Operational stats")
+{
+    GIVEN("Standard setup with an agreement and a started election")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        self.act<actions::setagreement>("test");
+        t.as("dan"_n).act<actions::startelect>();
+
+        THEN("Everything starts at zero")
+        {
+            auto stats = fractal_contract::get_stats();
+            CHECK(stats.signers == 0);
+            CHECK(stats.global.edenHolders == 0);
+            CHECK(stats.election.electionNr == 1);
+            CHECK(stats.submissions == 0);
+        }
+        THEN("Signing and unsigning are counted")
+        {
+            for (auto signer : {"alice"_n, "bob"_n, "charlie"_n}) {
+                t.as(signer).act<actions::sign>(signer);
+            }
+            t.as("bob"_n).act<actions::unsign>("bob"_n);
+            CHECK(fractal_contract::get_stats().signers == 2);
+        }
+        THEN("Signing doesn't write the shared counters row")
+        {
+            t.as("alice"_n).act<actions::sign>("alice"_n);
+            fractal_contract::GlobalStatsSingleton global(default_contract_account, default_contract_account.value);
+            CHECK(!global.exists());
+        }
+        WHEN("Two groups report and the ranks are submitted")
+        {
+            const vector<name> group1{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n};
+            const vector<name> group2{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n};
+            t.as("james"_n).act<actions::submitcons>(1, group1, "james"_n);
+            t.as("dan"_n).act<actions::submitcons>(1, group1, "dan"_n);
+            t.as("david"_n).act<actions::submitcons>(2, group2, "david"_n);
+            self.act<actions::submitranks>(AllRankings{{GroupRanking{group1}, GroupRanking{group2}}});
+
+            THEN("The election counters match")
+            {
+                auto stats = fractal_contract::get_stats();
+                CHECK(stats.submissions == 3);
+                CHECK(stats.groupsReported == 2);
+                CHECK(stats.election.edenMinted == fractal_contract::get_supply(eden_symbol.code()).amount);
+            }
+            THEN("Every ranked member holds EDEN, and the issuer's emptied row is not counted")
+            {
+                CHECK(fractal_contract::get_stats().global.edenHolders == 12);
+            }
+            THEN("Anyone can read them in one call")
+            {
+                CHECK(succeeded(t.as("alice"_n).trace<actions::getstats>()));
+            }
+        }
+    }
+}
+
+SCENARIO("State export")
+{
+    GIVEN("Two ranked groups, two of whose members signed the agreement")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        self.act<actions::setagreement>("test");
+        t.as("dan"_n).act<actions::startelect>();
+        t.as("alice"_n).act<actions::sign>("alice"_n);
+        t.as("bob"_n).act<actions::sign>("bob"_n);
+
+        vector<name> group1{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n};
+        vector<name> group2{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n};
+        self.act<actions::submitranks>(AllRankings{{GroupRanking{group1}, GroupRanking{group2}}});
+
+        auto export_all = [](uint32_t limit) {
+            std::vector<HolderState> records;
+            size_t pages = 0;
+            name cursor;
+            do {
+                auto page = fractal_contract::get_state_export(cursor, limit);
+                records.insert(records.end(), page.records.begin(), page.records.end());
+                cursor = page.next;
+                ++pages;
+            } while (cursor != name{});
+            return std::pair{records, pages};
+        };
+
+        THEN("Paging through the export lists every holder once, in name order, without the contract's emptied issuing row")
+        {
+            auto [records, pages] = export_all(5);
+            CHECK(pages == 3);
+
+            auto expected = group1;
+            expected.insert(expected.end(), group2.begin(), group2.end());
+            std::sort(expected.begin(), expected.end());
+            std::vector<name> owners;
+            for (const auto& record : records) {
+                owners.push_back(record.owner);
+                CHECK(record.balance == fractal_contract::get_balance(record.owner, eden_symbol.code()).amount);
+                bool signer = record.owner == "alice"_n || record.owner == "bob"_n;
+                CHECK(record.signedVersion == (signer ? std::optional<uint8_t>{1} : std::nullopt));
+            }
+            CHECK(owners == expected);
+        }
+        THEN("An empty page cannot be requested")
+        {
+            auto trace = t.as("alice"_n).trace<actions::exportstate>(name{}, 0);
+            CHECK(failed(trace));
+        }
+        THEN("Anyone can call exportstate")
+        {
+            CHECK(succeeded(t.as("alice"_n).trace<actions::exportstate>(name{}, 100)));
+        }
+    }
+}
+
+SCENARIO("Balance checkpoints")
+{
+    GIVEN("Weekly elections in which alice is ranked, except for the second one")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        const vector<name> group1{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n};
+        const vector<name> group2{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n};
+        t.create_account("kathy"_n);
+
+        std::vector<asset> aliceBalances;
+        for (bool aliceAttends : {true, false, true}) {
+            t.as("dan"_n).act<actions::startelect>();
+            auto ranking1 = group1;
+            if (!aliceAttends) {
+                ranking1[2] = "kathy"_n;
+            }
+            self.act<actions::submitranks>(AllRankings{{GroupRanking{ranking1}, GroupRanking{group2}}});
+            aliceBalances.push_back(fractal_contract::get_balance("alice"_n, eden_symbol.code()));
+            t.start_block(7 * 24 * 60 * 60 * 1000);
+        }
+
+        THEN("Her balance as of each election is the balance she had after it")
+        {
+            CHECK(fractal_contract::get_balance_at("alice"_n, 0).amount == 0);
+            CHECK(fractal_contract::get_balance_at("alice"_n, 1) == aliceBalances[0]);
+            CHECK(fractal_contract::get_balance_at("alice"_n, 2) == aliceBalances[1]);
+            CHECK(fractal_contract::get_balance_at("alice"_n, 3) == aliceBalances[2]);
+            CHECK(fractal_contract::get_balance_at("alice"_n, 10) == aliceBalances[2]);
+        }
+        THEN("Checkpoints are only written for elections in which her balance changed")
+        {
+            fractal_contract::CheckpointsTable checkpoints(default_contract_account, "alice"_n.value);
+            std::vector<uint64_t> elections;
+            for (const auto& row : checkpoints) {
+                elections.push_back(row.electionNr);
+            }
+            CHECK(elections == std::vector<uint64_t>{0, 1, 3});
+        }
+        THEN("A member who joined later had no balance before")
+        {
+            CHECK(fractal_contract::get_balance_at("kathy"_n, 1).amount == 0);
+            CHECK(fractal_contract::get_balance_at("kathy"_n, 2).amount > 0);
+        }
+        THEN("Accounts that never held EDEN have no balance")
+        {
+            CHECK(fractal_contract::get_balance_at("zed"_n, 3).amount == 0);
+        }
+        THEN("Anyone can look up a balance")
+        {
+            CHECK(succeeded(t.as("bob"_n).trace<actions::balanceat>("alice"_n, 2)));
+        }
+    }
+}
+
+SCENARIO("Attendance")
+{
+    GIVEN("A group meeting every week")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        const vector<name> group1{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n};
+        const vector<name> group2{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n};
+
+        // Runs one election; alice skips it unless `aliceAttends`
+        auto runElection = [&](bool aliceAttends) {
+            t.as("dan"_n).act<actions::startelect>();
+            t.as("james"_n).act<actions::submitcons>(1, group1, "james"_n);
+            auto ranking1 = group1;
+            if (!aliceAttends) {
+                ranking1[2] = "kathy"_n;
+            }
+            self.act<actions::submitranks>(AllRankings{{GroupRanking{ranking1}, GroupRanking{group2}}});
+            t.start_block(7 * 24 * 60 * 60 * 1000);
+        };
+        t.create_account("kathy"_n);
+
+        WHEN("Alice attends 3 elections, misses one, then attends 2 more")
+        {
+            for (bool attends : {true, true, true, false, true, true}) {
+                runElection(attends);
+            }
+
+            THEN("Her attendance and current streak are read from one row")
+            {
+                auto alice = fractal_contract::get_attendance("alice"_n);
+                CHECK(alice.lastElection == 6);
+                CHECK(alice.attended(6, 52) == 5);
+                CHECK(alice.attended(6, 3) == 2);
+                CHECK(alice.current_streak(6) == 2);
+            }
+            THEN("A member who attended every election has a full streak")
+            {
+                auto james = fractal_contract::get_attendance("james"_n);
+                CHECK(james.attended(6, 52) == 6);
+                CHECK(james.current_streak(6) == 6);
+            }
+            THEN("A streak ends once the member misses an election")
+            {
+                CHECK(fractal_contract::get_attendance("kathy"_n).current_streak(6) == 0);
+                CHECK(fractal_contract::get_attendance("kathy"_n).attended(6, 52) == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Results archive")
+{
+    GIVEN("Standard setup, and an admin has a ranking to submit")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        auto admin = t.as("dan"_n);
+
+        AllRankings ranks{{{{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n}}, {{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n}}}};
+
+        auto eosBalance = [](name owner) {
+            token::contract::accounts accountstable("eosio.token"_n, owner.value);
+            return accountstable.get(eden_fractal::eos_symbol.code().raw()).balance;
+        };
+
+        THEN("Nobody has archived respect yet")
+        {
+            auto respect = fractal_contract::get_respect("james"_n, 0, 100);
+            CHECK(respect.elections == 0);
+            CHECK(respect.eden.amount == 0);
+        }
+        WHEN("The ranking of the first election is submitted")
+        {
+            admin.act<actions::startelect>();
+            self.act<actions::submitranks>(ranks);
+
+            THEN("Every ranked member's archived respect matches what they were paid")
+            {
+                for (const auto& group : ranks.allRankings) {
+                    for (auto member : group.ranking) {
+                        auto respect = fractal_contract::get_respect(member, 1, 1);
+                        CHECK(respect.elections == 1);
+                        CHECK(respect.eden == fractal_contract::get_balance(member, eden_symbol.code()));
+                        CHECK(respect.eos == eosBalance(member));
+                    }
+                }
+            }
+            THEN("Rewards cannot be distributed twice in the same election")
+            {
+                t.start_block();
+                auto trace = self.trace<actions::submitranks>(ranks);
+                CHECK(failedWith(trace, alreadyDistributed));
+            }
+            THEN("A second submitranks in the same election is rejected before anything is minted, even for other rankings")
+            {
+                auto supply = fractal_contract::get_supply(eden_symbol.code());
+                auto jamesBalance = fractal_contract::get_balance("james"_n, eden_symbol.code());
+
+                AllRankings corrected = ranks;
+                std::reverse(corrected.allRankings[0].ranking.begin(), corrected.allRankings[0].ranking.end());
+                CHECK(failedWith(self.trace<actions::submitranks>(corrected), alreadyDistributed));
+                CHECK(failedWith(self.trace<actions::submitranks>(AllRankings{{ranks.allRankings[1], ranks.allRankings[0]}}), alreadyDistributed));
+
+                CHECK(fractal_contract::get_supply(eden_symbol.code()) == supply);
+                CHECK(fractal_contract::get_balance("james"_n, eden_symbol.code()) == jamesBalance);
+                CHECK(fractal_contract::get_respect("james"_n, 1, 1).elections == 1);
+            }
+            AND_WHEN("The same ranking is submitted in the second election")
+            {
+                admin.act<actions::startelect>();
+                self.act<actions::submitranks>(ranks);
+
+                THEN("Range queries sum the elections in range")
+                {
+                    auto first = fractal_contract::get_respect("igor"_n, 1, 1);
+                    auto both = fractal_contract::get_respect("igor"_n, 1, 2);
+                    auto second = fractal_contract::get_respect("igor"_n, 2, 5);
+
+                    CHECK(both.elections == 2);
+                    CHECK(second.elections == 1);
+                    CHECK(both.eden.amount == 2 * first.eden.amount);
+                    CHECK(both.eos.amount == first.eos.amount + second.eos.amount);
+                    CHECK(both.eden == fractal_contract::get_balance("igor"_n, eden_symbol.code()));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Respect decay")
+{
+    GIVEN("Standard setup, and an admin has a ranking to submit")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        auto admin = t.as("dan"_n);
+
+        AllRankings ranks{{{{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n}}, {{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n}}}};
+
+        auto respectRow = [](name member) {
+            fractal_contract::RespectTable table(default_contract_account, default_contract_account.value);
+            return table.get(member.value);
+        };
+
+        THEN("Alice cannot configure the decay")
+        {
+            auto trace = t.as("alice"_n).trace<actions::setdecay>(900'000);
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("The retained share must be a valid fraction")
+        {
+            CHECK(failedWith(self.trace<actions::setdecay>(0), invalidDecay));
+            CHECK(failedWith(self.trace<actions::setdecay>(1'000'001), invalidDecay));
+        }
+        WHEN("Respect does not decay and James is ranked in two elections")
+        {
+            for (int election = 0; election < 2; ++election) {
+                t.start_block();
+                admin.act<actions::startelect>();
+                self.act<actions::submitranks>(ranks);
+            }
+
+            THEN("His voting power is all the EDEN he earned")
+            {
+                CHECK(fractal_contract::get_decayed_respect("james"_n, 2) == fractal_contract::get_balance("james"_n, eden_symbol.code()));
+            }
+        }
+        WHEN("Respect keeps 90% per election and James is ranked in the first election")
+        {
+            self.act<actions::setdecay>(900'000);
+            admin.act<actions::startelect>();
+            self.act<actions::submitranks>(ranks);
+
+            auto earned = fractal_contract::get_balance("james"_n, eden_symbol.code()).amount;
+            auto tables = fractal_contract::get_decay_tables();
+
+            THEN("His voting power is what he earned")
+            {
+                CHECK(fractal_contract::get_decayed_respect("james"_n, 1).amount == earned);
+            }
+            AND_WHEN("Three elections pass without him")
+            {
+                for (int election = 0; election < 3; ++election) {
+                    t.start_block();
+                    admin.act<actions::startelect>();
+                }
+
+                THEN("His voting power decayed without his row being rewritten")
+                {
+                    CHECK(fractal_contract::get_decayed_respect("james"_n, 4).amount == decay::apply(tables, earned, 3));
+                    CHECK(respectRow("james"_n).lastElection == 1);
+                }
+                THEN("Being ranked again adds to the decayed value")
+                {
+                    t.start_block();
+                    self.act<actions::submitranks>(ranks);
+
+                    auto row = respectRow("james"_n);
+                    CHECK(row.lastElection == 4);
+                    CHECK(row.raw == decay::apply(tables, earned, 3) + earned);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Distribution log")
+{
+    GIVEN("Standard setup, and an admin has a ranking to submit")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+
+        AllRankings ranks{{{{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n}}, {{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n}}}};
+
+        auto countActions = [](const transaction_trace& trace, name receiver, name action) {
+            return std::count_if(trace.action_traces.begin(), trace.action_traces.end(), [&](const auto& a) {  //
+                return a.receiver == receiver && a.act.account == receiver && a.act.name == action;
+            });
+        };
+        auto logRecords = [](const transaction_trace& trace) {
+            std::vector<DistributionRecord> records;
+            for (const auto& a : trace.action_traces) {
+                if (a.receiver == default_contract_account && a.act.name == "logdistrib"_n) {
+                    input_stream data(a.act.data);
+                    uint64_t electionNr;
+                    from_bin(electionNr, data);
+                    from_bin(records, data);
+                }
+            }
+            return records;
+        };
+
+        THEN("Alice cannot log a distribution")
+        {
+            auto trace = t.as("alice"_n).trace<actions::logdistrib>(0, std::vector<DistributionRecord>{});
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("Only the contract account can turn member notifications off")
+        {
+            auto trace = t.as("dan"_n).trace<actions::membernotifs>(false);
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        WHEN("The ranking is submitted")
+        {
+            auto trace = self.trace<actions::submitranks>(ranks);
+            REQUIRE(succeeded(trace));
+
+            THEN("One logdistrib action records every member's rewards")
+            {
+                CHECK(countActions(trace, default_contract_account, "logdistrib"_n) == 1);
+
+                auto records = logRecords(trace);
+                REQUIRE(records.size() == 12);
+                CHECK(records[0].member == "james"_n);
+                CHECK(records[0].rank == 0);
+                CHECK(records[5].rank == 5);
+                CHECK(records[0].eden == s2a("5.0000 EDEN").amount);
+                CHECK(records[0].eos == s2a("1.8238 EOS").amount);
+                for (const auto& record : records) {
+                    CHECK(record.eden == fractal_contract::get_balance(record.member, eden_symbol.code()).amount);
+                }
+            }
+            THEN("EDEN is credited without token actions, and every member is notified once")
+            {
+                CHECK(countActions(trace, default_contract_account, "issue"_n) == 0);
+                CHECK(countActions(trace, default_contract_account, "transfer"_n) == 0);
+                CHECK(fractal_contract::get_balance(default_contract_account, eden_symbol.code()).amount == 0);
+                for (const auto& group : ranks.allRankings) {
+                    for (auto member : group.ranking) {
+                        CHECK(std::count_if(trace.action_traces.begin(), trace.action_traces.end(), [&](const auto& a) {
+                                  return a.receiver == member && a.act.account == default_contract_account && a.act.name == "submitranks"_n;
+                              }) == 1);
+                    }
+                }
+            }
+        }
+        WHEN("Member notifications are turned off and the ranking is submitted")
+        {
+            self.act<actions::membernotifs>(false);
+            auto trace = self.trace<actions::submitranks>(ranks);
+            REQUIRE(succeeded(trace));
+
+            THEN("No per-member EDEN actions are sent, and members are not notified")
+            {
+                CHECK(countActions(trace, default_contract_account, "issue"_n) == 0);
+                CHECK(countActions(trace, default_contract_account, "transfer"_n) == 0);
+                CHECK(std::none_of(trace.action_traces.begin(), trace.action_traces.end(), [](const auto& a) {
+                    return a.receiver != default_contract_account && a.act.name == "submitranks"_n;
+                }));
+            }
+            THEN("Balances and supply still match the logged rewards")
+            {
+                int64_t total = 0;
+                for (const auto& record : logRecords(trace)) {
+                    CHECK(record.eden == fractal_contract::get_balance(record.member, eden_symbol.code()).amount);
+                    total += record.eden;
+                }
+                CHECK(fractal_contract::get_supply(eden_symbol.code()).amount == total);
+                CHECK(fractal_contract::get_balance("james"_n, eden_symbol.code()) == s2a("5.0000 EDEN"));
+            }
+        }
+    }
+}
+
+SCENARIO("Schema migration")
+{
+    GIVEN("Standard setup with some signatures and a custom reward configuration")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        self.act<actions::setagreement>("test");
+        for (auto signer : {"alice"_n, "bob"_n, "charlie"_n}) {
+            t.as(signer).act<actions::sign>(signer);
+        }
+        self.act<actions::fiboffset>(6);
+
+        THEN("Alice cannot run a migration")
+        {
+            auto trace = t.as("alice"_n).trace<actions::migrate>("signatures"_n, 10);
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("Tables without a versioned layout cannot be migrated")
+        {
+            auto trace = self.trace<actions::migrate>("accounts"_n, 10);
+            CHECK(failedWith(trace, unknownTable));
+        }
+        WHEN("The signatures are migrated one row at a time")
+        {
+            for (int i = 0; i < 4; ++i) {
+                t.start_block();
+                CHECK(succeeded(self.trace<actions::migrate>("signatures"_n, 1)));
+            }
+
+            THEN("All signatures are still in the latest layout")
+            {
+                fractal_contract::SignersTable signers(default_contract_account, default_contract_account.value);
+                std::vector<name> stored;
+                for (const auto& row : signers) {
+                    CHECK(is_latest(row.value));
+                    stored.push_back(latest(row.value).signer);
+                }
+                CHECK(stored == std::vector<name>{"alice"_n, "bob"_n, "charlie"_n});
+            }
+            THEN("Signers can still unsign")
+            {
+                CHECK(succeeded(t.as("bob"_n).trace<actions::unsign>("bob"_n)));
+            }
+        }
+        WHEN("The reward configuration is migrated")
+        {
+            self.act<actions::migrate>("rewardconf"_n, 1);
+
+            THEN("The configured fib offset is kept")
+            {
+                fractal_contract::RewardConfigSingleton rewardConfig(default_contract_account, default_contract_account.value);
+                CHECK(latest(rewardConfig.get().value).fib_offset == 6);
+            }
+        }
+    }
+}
+
+SCENARIO("Merkle-root settlement")
+{
+    GIVEN("An election whose rewards were computed off-chain")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        auto alice = t.as("alice"_n);
+        t.as("dan"_n).act<actions::startelect>();
+
+        // An odd number of leaves, so some levels carry a node up without a sibling
+        std::vector<RewardLeaf> leaves;
+        for (auto member : {"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n, "david"_n}) {
+            auto index = static_cast<uint32_t>(leaves.size());
+            leaves.push_back(RewardLeaf{index, member, (index + 1) * 10000, (index + 1) * 5000});
+        }
+
+        std::vector<checksum256> hashes;
+        int64_t edenTotal = 0, eosTotal = 0;
+        for (const auto& leaf : leaves) {
+            hashes.push_back(merkle::leaf_hash(leaf));
+            edenTotal += leaf.eden;
+            eosTotal += leaf.eos;
+        }
+        auto root = merkle::root(hashes);
+
+        auto eosBalance = [](name owner) {
+            token::contract::accounts accountstable("eosio.token"_n, owner.value);
+            auto itr = accountstable.find(eden_fractal::eos_symbol.code().raw());
+            return (itr == accountstable.end()) ? int64_t{0} : itr->balance.amount;
+        };
+
+        THEN("Alice cannot set a reward root")
+        {
+            auto trace = alice.trace<actions::setroot>(1, root, leaves.size(), asset{edenTotal, eden_symbol}, asset{eosTotal, eos_symbol});
+            CHECK(failedWith(trace, missingRequiredAuth));
+        }
+        THEN("A reward root cannot be set for an election that has not started")
+        {
+            auto trace = self.trace<actions::setroot>(2, root, leaves.size(), asset{edenTotal, eden_symbol}, asset{eosTotal, eos_symbol});
+            CHECK(failedWith(trace, futureElection));
+        }
+        THEN("A reward root cannot have more leaves than the cap")
+        {
+            auto trace = self.trace<actions::setroot>(1, root, max_settlement_leaves + 1, asset{edenTotal, eden_symbol}, asset{eosTotal, eos_symbol});
+            CHECK(failedWith(trace, tooManyLeaves));
+            trace = self.trace<actions::setroot>(1, root, ~uint32_t{0}, asset{edenTotal, eden_symbol}, asset{eosTotal, eos_symbol});
+            CHECK(failedWith(trace, tooManyLeaves));
+        }
+        THEN("Nothing can be claimed before the root is set")
+        {
+            auto trace = alice.trace<actions::claimproof>(1, leaves[2], merkle::proof(hashes, 2));
+            CHECK(failedWith(trace, noSettlement));
+        }
+        WHEN("The reward root is set")
+        {
+            self.act<actions::setroot>(1, root, leaves.size(), asset{edenTotal, eden_symbol}, asset{eosTotal, eos_symbol});
+
+            THEN("Every member can claim their own leaf")
+            {
+                for (const auto& leaf : leaves) {
+                    auto trace = alice.trace<actions::claimproof>(1, leaf, merkle::proof(hashes, leaf.index));
+                    CHECK(succeeded(trace));
+                    CHECK(fractal_contract::get_balance(leaf.member, eden_symbol.code()).amount == leaf.eden);
+                    CHECK(eosBalance(leaf.member) == leaf.eos);
+                }
+                CHECK(fractal_contract::get_supply(eden_symbol.code()).amount == edenTotal);
+            }
+            THEN("A leaf cannot be claimed twice")
+            {
+                alice.act<actions::claimproof>(1, leaves[6], merkle::proof(hashes, 6));
+                t.start_block();
+                auto trace = alice.trace<actions::claimproof>(1, leaves[6], merkle::proof(hashes, 6));
+                CHECK(failedWith(trace, alreadyClaimed));
+            }
+            THEN("A leaf cannot be claimed once the max supply was minted by other means")
+            {
+                fractal_contract::stats statstable(default_contract_account, eden_symbol.code().raw());
+                auto available = statstable.get(eden_symbol.code().raw()).max_supply.amount - fractal_contract::get_supply(eden_symbol.code()).amount;
+                self.act<actions::issue>(default_contract_account, asset{available - leaves[6].eden + 1, eden_symbol}, "memo");
+
+                auto trace = alice.trace<actions::claimproof>(1, leaves[6], merkle::proof(hashes, 6));
+                CHECK(failedWith(trace, "quantity exceeds available supply"));
+                CHECK(succeeded(alice.trace<actions::claimproof>(1, leaves[0], merkle::proof(hashes, 0))));
+            }
+            THEN("A leaf with inflated rewards is rejected")
+            {
+                auto forged = leaves[3];
+                forged.eden *= 100;
+                auto trace = alice.trace<actions::claimproof>(1, forged, merkle::proof(hashes, 3));
+                CHECK(failedWith(trace, invalidProof));
+            }
+            THEN("The election cannot be distributed with submitranks as well")
+            {
+                AllRankings ranks{{{{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n}}, {{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n}}}};
+                auto trace = self.trace<actions::submitranks>(ranks);
+                CHECK(failedWith(trace, alreadyDistributed));
+            }
+        }
+    }
+}
+
+// Replays a year of weekly meetings and reports the cost of every election.
+// Hidden from the default run; use the `[season]` tag (see EDEN_FRACTAL_LOAD_TESTS in CMakeLists.txt).
+SCENARIO("Season replay", "[.][season]")
+{
+    GIVEN("A season worth of members, and an EOS budget for every meeting")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+        auto members = setup_createMembers(t, seasonRooms * roomSize);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        auto admin = t.as("dan"_n);
+
+        WHEN("Every election runs a full set of consensus submissions and a rank submission")
+        {
+            std::vector<UsageReport> reports;
+            printf("%8s %12s %12s   %s\n", "election", "cpu (us)", "ram (bytes)", "slowest action");
+
+            for (uint32_t election = 0; election < seasonElections; ++election) {
+                UsageReport report;
+                t.start_block();
+                report.add(admin.trace<actions::startelect>());
+
+                AllRankings ranks;
+                for (uint32_t room = 0; room < seasonRooms; ++room) {
+                    // Rotate the ranking every election so rewards spread over all members
+                    GroupRanking group;
+                    for (uint32_t seat = 0; seat < roomSize; ++seat) {
+                        group.ranking.push_back(members[room * roomSize + (seat + election) % roomSize]);
+                    }
+                    for (auto member : group.ranking) {
+                        report.add(t.as(member).trace<actions::submitcons>(room + 1, group.ranking, member));
+                    }
+                    ranks.allRankings.push_back(std::move(group));
+                    t.start_block();
+                }
+
+                auto submitRanks = self.trace<actions::submitranks>(ranks);
+                CHECK(succeeded(submitRanks));
+                report.add(submitRanks);
+
+                printf("%8u %12llu %12lld   %s (%lld us)\n", election + 1, (unsigned long long)report.cpu_us, (long long)report.ram_bytes,
+                       report.slowest_action.to_string().c_str(), (long long)report.slowest_us);
+                reports.push_back(report);
+
+                // Next week
+                t.start_block(7 * 24 * 60 * 60 * 1000);
+            }
+
+            // One section, so the season is replayed once
+            THEN("No election needs more RAM than the first full one, whoever pays for it, and CPU does not trend upwards")
+            {
+                // The first election also creates every member's balance and id rows
+                for (uint32_t election = 2; election < seasonElections; ++election) {
+                    CHECK(reports[election].ram_bytes <= reports[1].ram_bytes);
+                }
+
+                auto quarter = seasonElections / 4;
+                uint64_t first = 0, last = 0;
+                for (uint32_t i = 0; i < quarter; ++i) {
+                    first += reports[1 + i].cpu_us;
+                    last += reports[seasonElections - quarter + i].cpu_us;
+                }
+                // Billed CPU is wall-clock time, so only flag clear growth
+                CHECK(last <= 2 * first);
+            }
+        }
+    }
+}
+
+SCENARIO("Distribution memory budget", "[.][heap]")
+{
+    GIVEN("Enough members for a distribution to 100 groups, and the instrumented debug contract")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+        auto members = setup_createMembers(t, budgetGroups * roomSize);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        t.as("dan"_n).act<actions::startelect>();
+
+        AllRankings ranks;
+        for (uint32_t group = 0; group < budgetGroups; ++group) {
+            ranks.allRankings.push_back(GroupRanking{{members.begin() + group * roomSize, members.begin() + (group + 1) * roomSize}});
+        }
+
+        // The heap of submitranks itself, which credits EDEN in both modes. The inline EOS transfers it packs count here,
+        // but they run as their own actions.
+        auto distribute = [&](const char* mode) {
+            auto trace = self.trace<actions::submitranks>(ranks);
+            REQUIRE(succeeded(trace));
+
+            auto heap = HeapReport::of(trace, "submitranks"_n);
+            printf("submitranks, %u groups, %s: %u allocations, %llu bytes allocated, %llu bytes peak, %u pages of linear memory\n",
+                   budgetGroups, mode, heap.allocations, heap.bytes, heap.peak, heap.pages);
+            return heap;
+        };
+
+        WHEN("The ranks of all groups are submitted without member notifications")
+        {
+            self.act<actions::membernotifs>(false);
+            auto heap = distribute("notifications off");
+
+            THEN("The heap report was printed, and the distribution stays within its memory budget")
+            {
+                CHECK(heap.allocations > 0);
+                // simple-malloc never frees, so the allocated bytes are what counts against the memory ceiling
+                CHECK(heap.bytes <= distributionHeapBudget);
+            }
+        }
+        WHEN("The ranks of all groups are submitted with member notifications")
+        {
+            self.act<actions::membernotifs>(true);
+            auto heap = distribute("notifications on");
+
+            THEN("The heap report was printed, and the distribution stays within its memory budget")
+            {
+                CHECK(heap.allocations > 0);
+                // Notifying the members only adds their names to the action's recipients
+                CHECK(heap.bytes <= distributionHeapBudget);
+            }
+        }
+    }
+}
+
+SCENARIO("Cold start", "[.][coldstart]")
+{
+    GIVEN("A chain with an agreement, an ongoing election and EDEN to transfer")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        t.as(default_contract_account).act<actions::setagreement>("test");
+        t.as(default_contract_account).act<actions::issue>(default_contract_account, s2a("1000.0000 EDEN"), "memo");
+        t.as("dan"_n).act<actions::startelect>();
+
+        // The chain caches compiled contracts by code hash, so the contract is redeployed with a custom section naming
+        // the deployment appended. Its next action is then the first this chain runs of that code, and has to compile
+        // and instantiate it, like the first action after a node starts.
+        const auto code = read_whole_file("artifacts/eden_fractal.wasm");
+        uint32_t deployments = 0;
+        auto redeploy = [&] {
+            auto tag = "coldstart" + std::to_string(deployments++);
+            auto fresh = code;
+            fresh.push_back(0);                                  // Custom section id
+            fresh.push_back(static_cast<char>(1 + tag.size()));  // Section size
+            fresh.push_back(static_cast<char>(tag.size()));      // Section name
+            fresh.insert(fresh.end(), tag.begin(), tag.end());
+
+            action setcode{{{default_contract_account, "active"_n}}, "eosio"_n, "setcode"_n,
+                           std::make_tuple(default_contract_account, uint8_t{0}, uint8_t{0}, fresh)};
+            REQUIRE(succeeded(pushAction(t, std::move(setcode))));
+            t.start_block();
+        };
+
+        // The first call of an action on a fresh deployment, and a second call on the same code
+        struct ColdStart {
+            const char* action;
+            int64_t cold_us;
+            int64_t warm_us;
+            uint32_t cold_cpu_us;
+            uint32_t warm_cpu_us;
+        };
+        std::vector<ColdStart> results;
+        auto measure = [&](const char* action, auto&& first, auto&& second) {
+            redeploy();
+            auto cold = first();
+            auto warm = second();
+            REQUIRE(succeeded(cold));
+            REQUIRE(succeeded(warm));
+            results.push_back({action, cold.action_traces[0].elapsed, warm.action_traces[0].elapsed, cold.cpu_usage_us, warm.cpu_usage_us});
+        };
+
+        const vector<name> group{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n};
+        auto self = t.as(default_contract_account);
+        measure(
+            "sign", [&] { return t.as("alice"_n).trace<actions::sign>("alice"_n); }, [&] { return t.as("bob"_n).trace<actions::sign>("bob"_n); });
+        measure(
+            "submitcons", [&] { return t.as("alice"_n).trace<actions::submitcons>(1, group, "alice"_n); },
+            [&] { return t.as("bob"_n).trace<actions::submitcons>(1, group, "bob"_n); });
+        measure(
+            "transfer", [&] { return self.trace<actions::transfer>(default_contract_account, "alice"_n, s2a("1.0000 EDEN"), "memo"); },
+            [&] { return self.trace<actions::transfer>(default_contract_account, "bob"_n, s2a("1.0000 EDEN"), "memo"); });
+
+        printf("%-12s %10s %10s %10s %14s %14s\n", "action", "cold (us)", "warm (us)", "load (us)", "cold cpu (us)", "warm cpu (us)");
+        for (const auto& r : results) {
+            printf("%-12s %10lld %10lld %10lld %14u %14u\n", r.action, (long long)r.cold_us, (long long)r.warm_us, (long long)(r.cold_us - r.warm_us),
+                   r.cold_cpu_us, r.warm_cpu_us);
+        }
+
+        THEN("Loading the contract costs the first action time, and stays within the cold start budget")
+        {
+            for (const auto& r : results) {
+                INFO(r.action);
+                CHECK(r.warm_us > 0);
+                CHECK(r.cold_us > r.warm_us);
+                CHECK(r.cold_us <= coldStartBudgetUs);
+                CHECK(r.warm_us <= warmActionBudgetUs);
+            }
+        }
+    }
+}
+
+SCENARIO("Profile", "[.][profile]")
+{
+    GIVEN("A chain with an ongoing election and the instrumented debug contract")
+    {
+        test_chain t;
+        setup_installMyContract(t);
+        setup_createAccounts(t);
+        setup_token(t);
+        setup_fundContract(t);
+        auto members = setup_createMembers(t, budgetGroups * roomSize);
+
+        auto self = t.as(eden_fractal::default_contract_account);
+        t.as("dan"_n).act<actions::startelect>();
+        self.act<actions::membernotifs>(false);
+        self.act<actions::issue>(default_contract_account, s2a("1000.0000 EDEN"), "memo");
+
+        WHEN("A consensus, the distribution to every group and a transfer are profiled")
+        {
+            vector<name> group{members.begin(), members.begin() + roomSize};
+            auto submitcons = t.as(members[0]).trace<actions::submitcons>(1, group, members[0]);
+            REQUIRE(succeeded(submitcons));
+            AllRankings ranks;
+            for (uint32_t g = 0; g < budgetGroups; ++g) {
+                ranks.allRankings.push_back(GroupRanking{{members.begin() + g * roomSize, members.begin() + (g + 1) * roomSize}});
+            }
+            auto submitranks = self.trace<actions::submitranks>(ranks);
+            REQUIRE(succeeded(submitranks));
+            // EDEN is untradeable between members, so the transfer is the contract paying one
+            auto transfer = self.trace<actions::transfer>(default_contract_account, members[1], s2a("1.0000 EDEN"), "memo");
+            REQUIRE(succeeded(transfer));
+
+            THEN("Every action printed a timed profile")
+            {
+                CHECK(print_profile(submitcons) > 0);
+                CHECK(print_profile(transfer) > 0);
+                CHECK(print_profile(submitranks) > 0);
+            }
+        }
+    }
+}
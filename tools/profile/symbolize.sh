@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# Turns the "flame <action>;<fn>;<fn>... <ticks>" lines printed by the [profile] scenario into
+# collapsed stacks for flamegraph.pl, replacing wasm table indices with function names.
+#
+# Parameter 1 = debug wasm the profile was taken from (built with EDEN_FRACTAL_PROFILE)
+# Parameter 2 = cltester output (default: stdin)
+#
+# Requires wasm-objdump (wabt). Example Usage:
+# ./tools/profile/symbolize.sh build/artifacts/eden_fractal-debug.wasm build/artifacts/eden_fractal.profile > eden_fractal.folded
+# flamegraph.pl --countname ticks eden_fractal.folded > eden_fractal.svg
+
+set -e
+
+# Lines like " - elem[12] = func[345] <eden_fractal::fractal_contract::submitranks(...)>"
+names=$(wasm-objdump -x -j Elem "$1" | sed -n 's/^ *- elem\[\([0-9]*\)\] = func\[[0-9]*\] <\(.*\)>$/\1 \2/p')
+
+awk '
+    NR == FNR { idx = $1; sub(/^[0-9]+ /, ""); names[idx] = $0; next }
+    $1 != "flame" { next }
+    {
+        count = $NF
+        stack = substr($0, 7, length($0) - 7 - length(count))
+        n = split(stack, frames, ";")
+        out = frames[1]
+        for (i = 2; i <= n; i++) {
+            name = frames[i]
+            if (name in names) {
+                name = names[name]
+            } else if (name ~ /^[0-9]+$/) {
+                name = "func_" name
+            }
+            gsub(/;/, ":", name)
+            out = out ";" name
+        }
+        folded[out] += count
+    }
+    END { for (s in folded) print s, folded[s] }
+' <(echo "$names") "${2:-/dev/stdin}"
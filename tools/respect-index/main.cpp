@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <eosio/name.hpp>
+#include <string>
+
+#include "respect_index.hpp"
+#include "state_history.hpp"
+
+using namespace eden_fractal::tools;
+
+namespace {
+
+    constexpr auto defaultContract = "eden.fractal";
+
+    int usage()
+    {
+        std::fprintf(stderr,
+                     "usage:\n"
+                     "  respect-index record <state-history-dir> <trace-log> <last-irreversible-block> [contract]\n"
+                     "  respect-index ingest <index-dir> <trace-log> [contract]\n"
+                     "  respect-index leaderboard <index-dir> [count]\n"
+                     "  respect-index history <index-dir> <member>\n");
+        return 1;
+    }
+
+    double micros_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        return usage();
+    }
+    std::string command = argv[1];
+    std::string directory = argv[2];
+
+    try {
+        if (command == "record" && argc >= 5) {
+            // Here argv[2] is the state-history directory of a node rather than an index directory
+            auto contract = eosio::name(argc >= 6 ? argv[5] : defaultContract);
+            auto start = std::chrono::steady_clock::now();
+            auto result = record(directory, argv[3], contract, std::strtoul(argv[4], nullptr, 10));
+            std::printf("recorded %llu entries up to block %u in %.0f us\n", (unsigned long long)result.entries, result.lastBlock, micros_since(start));
+        }
+        else if (command == "ingest" && argc >= 4) {
+            auto contract = eosio::name(argc >= 5 ? argv[4] : defaultContract);
+            RespectIndex index(directory, contract, true);
+            auto start = std::chrono::steady_clock::now();
+            auto count = index.ingest(argv[3]);
+            std::printf("ingested %llu entries in %.0f us\n", (unsigned long long)count, micros_since(start));
+        }
+        else if (command == "leaderboard") {
+            RespectIndex index(directory, eosio::name(defaultContract), false);
+            auto count = argc >= 4 ? std::strtoul(argv[3], nullptr, 10) : 10;
+            auto start = std::chrono::steady_clock::now();
+            auto leaders = index.leaderboard(count);
+            auto elapsed = micros_since(start);
+            for (const auto& t : leaders) {
+                std::printf("%-13s eden %lld eos %lld balance %lld elections %u\n", eosio::name(t.member).to_string().c_str(), (long long)t.eden,
+                            (long long)t.eos, (long long)t.balance, t.elections);
+            }
+            std::printf("query took %.1f us\n", elapsed);
+        }
+        else if (command == "history" && argc >= 4) {
+            RespectIndex index(directory, eosio::name(defaultContract), false);
+            auto start = std::chrono::steady_clock::now();
+            auto entries = index.history(eosio::name(argv[3]));
+            auto elapsed = micros_since(start);
+            for (const auto& e : entries) {
+                std::printf("election %llu rank %u eden %lld eos %lld\n", (unsigned long long)e.electionNr, e.rank, (long long)e.eden, (long long)e.eos);
+            }
+            std::printf("query took %.1f us\n", elapsed);
+        }
+        else {
+            return usage();
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace eden_fractal::tools {
+
+    // A file mapped into memory. Writable files grow in place by remapping.
+    class MappedFile {
+       public:
+        MappedFile(const std::string& path, bool writable) : path(path), writable(writable)
+        {
+            fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+            if (fd < 0) {
+                throw std::runtime_error("cannot open " + path);
+            }
+            struct stat st;
+            ::fstat(fd, &st);
+            map(static_cast<size_t>(st.st_size));
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            unmap();
+            ::close(fd);
+        }
+
+        const char* data() const { return base; }
+        char* data() { return base; }
+        size_t size() const { return length; }
+
+        // Grows the file to at least `minSize` bytes. Doubles the size to keep appends amortized O(1)
+        void reserve(size_t minSize)
+        {
+            if (minSize <= length) {
+                return;
+            }
+            auto newSize = std::max(minSize, length * 2);
+            if (::ftruncate(fd, static_cast<off_t>(newSize)) != 0) {
+                throw std::runtime_error("cannot grow " + path);
+            }
+            unmap();
+            map(newSize);
+        }
+
+        // Writes the mapped pages back to the file before returning
+        void sync()
+        {
+            if (base && ::msync(base, length, MS_SYNC) != 0) {
+                throw std::runtime_error("cannot sync " + path);
+            }
+        }
+
+        // Replaces the whole content, used for the derived files that are rebuilt after each ingest
+        void assign(const void* bytes, size_t size)
+        {
+            if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                throw std::runtime_error("cannot resize " + path);
+            }
+            unmap();
+            map(size);
+            if (size > 0) {
+                std::memcpy(base, bytes, size);
+            }
+        }
+
+       private:
+        void map(size_t size)
+        {
+            length = size;
+            if (size == 0) {
+                return;
+            }
+            auto prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+            auto addr = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                throw std::runtime_error("cannot map " + path);
+            }
+            base = static_cast<char*>(addr);
+        }
+
+        void unmap()
+        {
+            if (base) {
+                ::munmap(base, length);
+                base = nullptr;
+            }
+        }
+
+        std::string path;
+        bool writable;
+        int fd = -1;
+        char* base = nullptr;
+        size_t length = 0;
+    };
+
+    // An append-only column of fixed-size values. The first 8 bytes of the file hold the number of values.
+    // The count is written after the value, so a reader never sees a partially appended value.
+    template <typename T>
+    class Column {
+       public:
+        Column(const std::string& path, bool writable) : file(path, writable)
+        {
+            if (writable && file.size() < sizeof(uint64_t)) {
+                file.reserve(sizeof(uint64_t) + 64 * sizeof(T));
+                set_count(0);
+            }
+        }
+
+        uint64_t size() const { return file.size() < sizeof(uint64_t) ? 0 : *reinterpret_cast<const uint64_t*>(file.data()); }
+
+        const T* begin() const { return reinterpret_cast<const T*>(file.data() + sizeof(uint64_t)); }
+        const T* end() const { return begin() + size(); }
+        const T& operator[](uint64_t i) const { return begin()[i]; }
+
+        void push_back(const T& value)
+        {
+            auto n = size();
+            file.reserve(sizeof(uint64_t) + (n + 1) * sizeof(T));
+            std::memcpy(file.data() + sizeof(uint64_t) + n * sizeof(T), &value, sizeof(T));
+            set_count(n + 1);
+        }
+
+        void sync() { file.sync(); }
+
+        // Drops the values from index `n` on, e.g. ones appended by an ingest that did not complete
+        void truncate(uint64_t n)
+        {
+            if (n < size()) {
+                set_count(n);
+            }
+        }
+
+       private:
+        void set_count(uint64_t n) { std::memcpy(file.data(), &n, sizeof(n)); }
+
+        MappedFile file;
+    };
+
+}  // namespace eden_fractal::tools
@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <eosio/from_bin.hpp>
+#include <eosio/stream.hpp>
+
+#include "respect_index.hpp"
+
+using namespace eden_fractal;
+using namespace eden_fractal::tools;
+using eosio::name;
+using namespace eosio::literals;
+
+namespace {
+
+    // Largest group of the distributions that predate logdistrib, whose rank indices the index derives itself
+    constexpr size_t legacyMaxGroupSize = 6;
+
+    // Arguments of the contract actions the index decodes
+    struct SubmitconsArgs {
+        uint64_t groupnr;
+        std::vector<name> rankings;
+        name submitter;
+    };
+    EOSIO_REFLECT(SubmitconsArgs, groupnr, rankings, submitter);
+
+    struct SubmitgroupArgs {
+        uint64_t electionNr;
+        uint64_t groupnr;
+        std::vector<name> rankings;
+        std::vector<name> signers;
+    };
+    EOSIO_REFLECT(SubmitgroupArgs, electionNr, groupnr, rankings, signers);
+
+    struct LogdistribArgs {
+        uint64_t electionNr;
+        std::vector<DistributionRecord> records;
+    };
+    EOSIO_REFLECT(LogdistribArgs, electionNr, records);
+
+    struct TransferArgs {
+        name from;
+        name to;
+        eosio::asset quantity;
+        std::string memo;
+    };
+    EOSIO_REFLECT(TransferArgs, from, to, quantity, memo);
+
+    template <typename T>
+    T decode(const std::vector<char>& bin)
+    {
+        eosio::input_stream stream(bin.data(), bin.data() + bin.size());
+        return eosio::from_bin<T>(stream);
+    }
+
+    std::string file_in(const std::string& directory, const char* file)
+    {
+        return directory + "/" + file;
+    }
+
+}  // namespace
+
+RespectIndex::RespectIndex(const std::string& directory, name contract, bool writable)
+    : directory(directory)
+    , contract(contract)
+    , state(file_in(directory, "state"), writable)
+    , payoutElection(file_in(directory, "payout.election"), writable)
+    , payoutMember(file_in(directory, "payout.member"), writable)
+    , payoutRank(file_in(directory, "payout.rank"), writable)
+    , payoutEden(file_in(directory, "payout.eden"), writable)
+    , payoutEos(file_in(directory, "payout.eos"), writable)
+    , submissionElection(file_in(directory, "submission.election"), writable)
+    , submissionGroup(file_in(directory, "submission.group"), writable)
+    , submissionMember(file_in(directory, "submission.member"), writable)
+    , balanceMember(file_in(directory, "balance.member"), writable)
+    , balanceAmount(file_in(directory, "balance.amount"), writable)
+    , totalsFile(file_in(directory, "totals"), writable)
+    , leaderboardFile(file_in(directory, "leaderboard"), writable)
+    , byMemberFile(file_in(directory, "bymember"), writable)
+{
+}
+
+RespectIndex::IngestState RespectIndex::committed() const
+{
+    return state.size() > 0 ? state[state.size() - 1] : IngestState{};
+}
+
+uint64_t RespectIndex::ingest(const std::string& logPath)
+{
+    // Drop whatever an ingest that crashed before committing appended
+    auto last = committed();
+    payoutElection.truncate(last.payoutRows);
+    payoutMember.truncate(last.payoutRows);
+    payoutRank.truncate(last.payoutRows);
+    payoutEden.truncate(last.payoutRows);
+    payoutEos.truncate(last.payoutRows);
+    submissionElection.truncate(last.submissionRows);
+    submissionGroup.truncate(last.submissionRows);
+    submissionMember.truncate(last.submissionRows);
+    balanceMember.truncate(last.balanceRows);
+    balanceAmount.truncate(last.balanceRows);
+
+    electionNr = last.electionNr;
+    balances.clear();
+    for (uint64_t row = 0; row < balanceMember.size(); ++row) {
+        balances[balanceMember[row]] = balanceAmount[row];
+    }
+
+    TraceLogReader reader(logPath, last.logOffset);
+    LogEntry entry;
+    uint64_t count = 0;
+    while (reader.next(entry)) {
+        std::visit(
+            [&](const auto& e) {
+                if (pending && e.blockNum != pending->blockNum) {
+                    finish_pending();
+                }
+                apply(e);
+            },
+            entry);
+        ++count;
+    }
+    finish_pending();
+
+    // The columns reach the disk before the state entry that commits them
+    payoutElection.sync();
+    payoutMember.sync();
+    payoutRank.sync();
+    payoutEden.sync();
+    payoutEos.sync();
+    submissionElection.sync();
+    submissionGroup.sync();
+    submissionMember.sync();
+    balanceMember.sync();
+    balanceAmount.sync();
+    state.push_back(IngestState{.logOffset = reader.offset(),
+                                .electionNr = electionNr,
+                                .payoutRows = payoutMember.size(),
+                                .submissionRows = submissionMember.size(),
+                                .balanceRows = balanceMember.size()});
+    state.sync();
+    rebuild();
+    return count;
+}
+
+void RespectIndex::apply(const ActionTrace& trace)
+{
+    if (trace.account == "eosio.token"_n && trace.action == "transfer"_n && trace.receiver == trace.account) {
+        auto args = decode<TransferArgs>(trace.data);
+        if (pending && !pending->logged && args.from == contract) {
+            for (auto& record : pending->records) {
+                if (record.member == args.to) {
+                    record.eos += args.quantity.amount;
+                }
+            }
+        }
+        return;
+    }
+
+    // Skip the copies of the contract's actions received by notified accounts
+    if (trace.account != contract || trace.receiver != contract) {
+        return;
+    }
+
+    if (trace.action == "submitranks"_n) {
+        auto ranks = decode<AllRankings>(trace.data);
+        pending = std::make_unique<PendingDistribution>(PendingDistribution{.blockNum = trace.blockNum, .logged = false});
+        for (const auto& group : ranks.allRankings) {
+            // Same rank indices as logdistrib, with the group sizes of the contract before setrewardcfg
+            auto rankIndex = static_cast<uint8_t>(legacyMaxGroupSize - std::min(group.ranking.size(), legacyMaxGroupSize));
+            for (auto member : group.ranking) {
+                pending->records.push_back(DistributionRecord{.member = member, .rank = rankIndex++, .eden = 0, .eos = 0});
+            }
+        }
+    }
+    else if (trace.action == "logdistrib"_n) {
+        auto args = decode<LogdistribArgs>(trace.data);
+        for (const auto& record : args.records) {
+            append_payout(args.electionNr, record);
+        }
+        if (pending) {
+            pending->logged = true;
+        }
+    }
+    else if (trace.action == "submitcons"_n) {
+        auto args = decode<SubmitconsArgs>(trace.data);
+        submissionElection.push_back(electionNr);
+        submissionGroup.push_back(args.groupnr);
+        submissionMember.push_back(args.submitter.value);
+    }
+    else if (trace.action == "submitgroup"_n) {
+        auto args = decode<SubmitgroupArgs>(trace.data);
+        for (auto signer : args.signers) {
+            submissionElection.push_back(args.electionNr);
+            submissionGroup.push_back(args.groupnr);
+            submissionMember.push_back(signer.value);
+        }
+    }
+}
+
+void RespectIndex::apply(const TableDelta& delta)
+{
+    if (delta.code != contract) {
+        return;
+    }
+
+    if (delta.table == "accounts"_n) {
+        auto balance = delta.present ? decode<account>(delta.value).balance.amount : 0;
+        auto& previous = balances[delta.scope.value];
+        if (pending && !pending->logged) {
+            for (auto& record : pending->records) {
+                if (record.member == delta.scope) {
+                    record.eden += balance - previous;
+                }
+            }
+        }
+        previous = balance;
+        balanceMember.push_back(delta.scope.value);
+        balanceAmount.push_back(balance);
+    }
+    else if (delta.table == "electioninf"_n && delta.present) {
+        electionNr = decode<ElectionInf>(delta.value).electionNr;
+    }
+}
+
+void RespectIndex::finish_pending()
+{
+    if (pending && !pending->logged) {
+        for (const auto& record : pending->records) {
+            append_payout(electionNr, record);
+        }
+    }
+    pending.reset();
+}
+
+void RespectIndex::append_payout(uint64_t election, const DistributionRecord& record)
+{
+    payoutElection.push_back(election);
+    payoutMember.push_back(record.member.value);
+    payoutRank.push_back(record.rank);
+    payoutEden.push_back(record.eden);
+    payoutEos.push_back(record.eos);
+}
+
+void RespectIndex::rebuild()
+{
+    auto numRows = payoutMember.size();
+
+    std::vector<uint64_t> byMember(numRows);
+    for (uint64_t row = 0; row < numRows; ++row) {
+        byMember[row] = row;
+    }
+    std::stable_sort(byMember.begin(), byMember.end(), [&](auto a, auto b) { return payoutMember[a] < payoutMember[b]; });
+
+    std::vector<MemberTotals> totals;
+    for (auto row : byMember) {
+        if (totals.empty() || totals.back().member != payoutMember[row]) {
+            totals.push_back(MemberTotals{.member = payoutMember[row]});
+        }
+        auto& t = totals.back();
+        t.eden += payoutEden[row];
+        t.eos += payoutEos[row];
+        t.elections += 1;
+    }
+
+    // Token holders that never received a distribution still get a balance
+    std::vector<MemberTotals> holders;
+    for (auto [member, balance] : balances) {
+        auto it = std::lower_bound(totals.begin(), totals.end(), member, [](const auto& t, uint64_t m) { return t.member < m; });
+        if (it != totals.end() && it->member == member) {
+            it->balance = balance;
+        }
+        else {
+            holders.push_back(MemberTotals{.member = member, .balance = balance});
+        }
+    }
+    totals.insert(totals.end(), holders.begin(), holders.end());
+    std::sort(totals.begin(), totals.end(), [](const auto& a, const auto& b) { return a.member < b.member; });
+
+    std::vector<uint32_t> leaderboard(totals.size());
+    for (uint32_t i = 0; i < leaderboard.size(); ++i) {
+        leaderboard[i] = i;
+    }
+    std::stable_sort(leaderboard.begin(), leaderboard.end(), [&](auto a, auto b) { return totals[a].eden > totals[b].eden; });
+
+    totalsFile.assign(totals.data(), totals.size() * sizeof(MemberTotals));
+    leaderboardFile.assign(leaderboard.data(), leaderboard.size() * sizeof(uint32_t));
+    byMemberFile.assign(byMember.data(), byMember.size() * sizeof(uint64_t));
+}
+
+const MemberTotals* RespectIndex::find_totals(name member) const
+{
+    auto begin = reinterpret_cast<const MemberTotals*>(totalsFile.data());
+    auto end = begin + totalsFile.size() / sizeof(MemberTotals);
+    auto it = std::lower_bound(begin, end, member.value, [](const auto& t, uint64_t m) { return t.member < m; });
+    return (it != end && it->member == member.value) ? it : nullptr;
+}
+
+std::vector<MemberTotals> RespectIndex::leaderboard(size_t count) const
+{
+    auto totals = reinterpret_cast<const MemberTotals*>(totalsFile.data());
+    auto order = reinterpret_cast<const uint32_t*>(leaderboardFile.data());
+    count = std::min(count, leaderboardFile.size() / sizeof(uint32_t));
+
+    std::vector<MemberTotals> result;
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(totals[order[i]]);
+    }
+    return result;
+}
+
+std::vector<HistoryEntry> RespectIndex::history(name member) const
+{
+    auto begin = reinterpret_cast<const uint64_t*>(byMemberFile.data());
+    auto end = begin + byMemberFile.size() / sizeof(uint64_t);
+
+    std::vector<HistoryEntry> result;
+    auto first = std::partition_point(begin, end, [&](auto row) { return payoutMember[row] < member.value; });
+    for (auto it = first; it != end && payoutMember[*it] == member.value; ++it) {
+        result.push_back(HistoryEntry{.electionNr = payoutElection[*it], .rank = payoutRank[*it], .eden = payoutEden[*it], .eos = payoutEos[*it]});
+    }
+    return result;
+}
+
+std::vector<Submission> RespectIndex::submissions(name member) const
+{
+    // Submissions are only a few per member and election, a scan of the member column is fast enough
+    std::vector<Submission> result;
+    auto rows = std::min(submissionMember.size(), committed().submissionRows);
+    for (uint64_t row = 0; row < rows; ++row) {
+        if (submissionMember[row] == member.value) {
+            result.push_back(Submission{.electionNr = submissionElection[row], .groupNr = submissionGroup[row]});
+        }
+    }
+    return result;
+}
+
+MemberTotals RespectIndex::totals(name member) const
+{
+    auto found = find_totals(member);
+    return found ? *found : MemberTotals{.member = member.value};
+}
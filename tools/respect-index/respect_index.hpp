@@ -0,0 +1,106 @@
+#pragma once
+
+#include <eosio/name.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "schemas.hpp"
+#include "trace_log.hpp"
+
+namespace eden_fractal::tools {
+
+    struct MemberTotals {
+        uint64_t member;
+        int64_t eden;     // Total EDEN paid out by distributions
+        int64_t eos;      // Total EOS paid out by distributions
+        int64_t balance;  // Current EDEN balance, from the token deltas
+        uint32_t elections;
+    };
+
+    struct HistoryEntry {
+        uint64_t electionNr;
+        uint8_t rank;
+        int64_t eden;
+        int64_t eos;
+    };
+
+    struct Submission {
+        uint64_t electionNr;
+        uint64_t groupNr;
+    };
+
+    // Per-member respect index built from a recorded trace log.
+    //
+    // Ingested data lives in append-only columns, one file per field, so history is never rewritten.
+    // An ingest is committed by appending its log offset and the column lengths to the `state` column. A crashed
+    // ingest leaves values past those lengths, which the next ingest drops before it resumes at the committed offset.
+    // After each ingest the derived files (per-member totals, leaderboard order, per-member row lists) are rebuilt
+    // from the committed columns, so queries are a binary search or a prefix read of a mapped file.
+    class RespectIndex {
+       public:
+        RespectIndex(const std::string& directory, eosio::name contract, bool writable);
+
+        // Ingests the entries of `logPath` that weren't ingested yet. Returns the number of entries read
+        uint64_t ingest(const std::string& logPath);
+
+        std::vector<MemberTotals> leaderboard(size_t count) const;
+        std::vector<HistoryEntry> history(eosio::name member) const;
+        std::vector<Submission> submissions(eosio::name member) const;
+        MemberTotals totals(eosio::name member) const;
+
+       private:
+        struct IngestState {
+            uint64_t logOffset;
+            uint64_t electionNr;
+            uint64_t payoutRows;
+            uint64_t submissionRows;
+            uint64_t balanceRows;
+        };
+
+        // Ranks of a submitranks action whose amounts are taken from the token deltas, for history that predates logdistrib
+        struct PendingDistribution {
+            uint32_t blockNum;
+            bool logged;
+            std::vector<DistributionRecord> records;
+        };
+
+        void apply(const ActionTrace& trace);
+        void apply(const TableDelta& delta);
+        void finish_pending();
+        void append_payout(uint64_t electionNr, const DistributionRecord& record);
+        void rebuild();
+
+        IngestState committed() const;
+
+        const MemberTotals* find_totals(eosio::name member) const;
+
+        std::string directory;
+        eosio::name contract;
+
+        Column<IngestState> state;
+        Column<uint64_t> payoutElection;
+        Column<uint64_t> payoutMember;
+        Column<uint8_t> payoutRank;
+        Column<int64_t> payoutEden;
+        Column<int64_t> payoutEos;
+        Column<uint64_t> submissionElection;
+        Column<uint64_t> submissionGroup;
+        Column<uint64_t> submissionMember;
+        Column<uint64_t> balanceMember;
+        Column<int64_t> balanceAmount;
+
+        // Derived files
+        MappedFile totalsFile;       // MemberTotals sorted by member
+        MappedFile leaderboardFile;  // uint32_t indices into totalsFile, by EDEN paid out, descending
+        MappedFile byMemberFile;     // uint64_t payout rows sorted by member, then election
+
+        // Ingest-time state
+        uint64_t electionNr = 0;
+        std::map<uint64_t, int64_t> balances;
+        std::unique_ptr<PendingDistribution> pending;
+    };
+
+}  // namespace eden_fractal::tools
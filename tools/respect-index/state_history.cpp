@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <eosio/ship_protocol.hpp>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "state_history.hpp"
+#include "trace_log.hpp"
+
+using namespace eden_fractal::tools;
+using eosio::name;
+using namespace eosio::literals;
+
+namespace {
+
+    struct Progress {
+        uint64_t logSize;
+        uint64_t tracesPos;
+        uint64_t deltasPos;
+    };
+
+    // Every entry of a state-history log is this header, the payload, and the entry's own start position
+    constexpr uint64_t headerSize = 8 + 32 + 8;
+    constexpr uint64_t trailerSize = 8;
+
+    struct Entry {
+        uint32_t blockNum;
+        const char* payload;
+        uint64_t payloadSize;
+        uint64_t next;  // Position of the following entry
+    };
+
+    // Reads the entry at `pos`, or returns false when it isn't completely written yet
+    bool read_entry(const MappedFile& file, uint64_t pos, Entry& entry)
+    {
+        if (pos + headerSize > file.size()) {
+            return false;
+        }
+        auto header = file.data() + pos;
+
+        uint64_t magic, payloadSize;
+        std::memcpy(&magic, header, 8);
+        std::memcpy(&payloadSize, header + 40, 8);
+        if ((magic & 0xffff'ffff'0000'0000) != "ship"_n.value || (magic & 0xffff) > 1) {
+            throw std::runtime_error("unsupported state-history log entry");
+        }
+        if (pos + headerSize + payloadSize + trailerSize > file.size()) {
+            return false;
+        }
+
+        // The block id starts with the block number, big-endian
+        auto id = reinterpret_cast<const unsigned char*>(header + 8);
+        entry.blockNum = uint32_t(id[0]) << 24 | uint32_t(id[1]) << 16 | uint32_t(id[2]) << 8 | id[3];
+        entry.payload = header + headerSize;
+        entry.payloadSize = payloadSize;
+        entry.next = pos + headerSize + payloadSize + trailerSize;
+        return true;
+    }
+
+    // Payloads are a uint32 size followed by a zlib stream
+    std::vector<char> inflate_payload(const Entry& entry)
+    {
+        if (entry.payloadSize < sizeof(uint32_t)) {
+            return {};
+        }
+        z_stream stream{};
+        if (inflateInit(&stream) != Z_OK) {
+            throw std::runtime_error("cannot inflate state-history payload");
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(entry.payload + sizeof(uint32_t)));
+        stream.avail_in = static_cast<uInt>(entry.payloadSize - sizeof(uint32_t));
+
+        std::vector<char> out;
+        int result = Z_OK;
+        while (result == Z_OK) {
+            out.resize(out.size() + 64 * 1024);
+            stream.next_out = reinterpret_cast<Bytef*>(out.data() + stream.total_out);
+            stream.avail_out = static_cast<uInt>(out.size() - stream.total_out);
+            result = inflate(&stream, Z_NO_FLUSH);
+        }
+        out.resize(stream.total_out);
+        inflateEnd(&stream);
+        if (result != Z_STREAM_END) {
+            throw std::runtime_error("corrupt state-history payload");
+        }
+        return out;
+    }
+
+    std::vector<char> bytes_of(const eosio::input_stream& stream)
+    {
+        return {stream.pos, stream.end};
+    }
+
+    // Appends the contract's actions, and EOS transfers sent by the contract, of the executed transactions of a block
+    void record_traces(const Entry& entry, name contract, std::vector<char>& log, uint64_t& count)
+    {
+        auto bin = inflate_payload(entry);
+        eosio::input_stream stream(bin.data(), bin.data() + bin.size());
+        auto traces = eosio::from_bin<std::vector<eosio::ship_protocol::transaction_trace>>(stream);
+
+        for (const auto& trace : traces) {
+            std::visit(
+                [&](const auto& t) {
+                    if (t.status != eosio::ship_protocol::transaction_status::executed) {
+                        return;
+                    }
+                    for (const auto& action : t.action_traces) {
+                        std::visit(
+                            [&](const auto& a) {
+                                const auto& act = a.act;
+                                bool fromContract = act.account == contract && a.receiver == contract;
+                                bool eosPayout = act.account == "eosio.token"_n && act.name == "transfer"_n && a.receiver == act.account &&
+                                                 act.data.remaining() >= 8 && std::memcmp(act.data.pos, &contract.value, 8) == 0;
+                                if (a.receipt && (fromContract || eosPayout)) {
+                                    append_entry(log, ActionTrace{.blockNum = entry.blockNum,
+                                                                  .receiver = a.receiver,
+                                                                  .account = act.account,
+                                                                  .action = act.name,
+                                                                  .data = bytes_of(act.data)});
+                                    ++count;
+                                }
+                            },
+                            action);
+                    }
+                },
+                trace);
+        }
+    }
+
+    // Appends the changes to the contract's table rows in a block
+    void record_deltas(const Entry& entry, name contract, std::vector<char>& log, uint64_t& count)
+    {
+        auto bin = inflate_payload(entry);
+        eosio::input_stream stream(bin.data(), bin.data() + bin.size());
+        auto deltas = eosio::from_bin<std::vector<eosio::ship_protocol::table_delta>>(stream);
+
+        for (const auto& delta : deltas) {
+            std::visit(
+                [&](const auto& d) {
+                    if (d.name != "contract_row") {
+                        return;
+                    }
+                    for (const auto& row : d.rows) {
+                        auto data = row.data;
+                        auto contractRow = eosio::from_bin<eosio::ship_protocol::contract_row>(data);
+                        std::visit(
+                            [&](const auto& r) {
+                                if (r.code != contract) {
+                                    return;
+                                }
+                                append_entry(log, TableDelta{.blockNum = entry.blockNum,
+                                                             .code = r.code,
+                                                             .scope = r.scope,
+                                                             .table = r.table,
+                                                             .primaryKey = r.primary_key,
+                                                             .present = bool(row.present),
+                                                             .value = bytes_of(r.value)});
+                                ++count;
+                            },
+                            contractRow);
+                    }
+                },
+                delta);
+        }
+    }
+
+    Progress read_progress(const std::string& path)
+    {
+        Progress progress{};
+        if (auto file = std::fopen(path.c_str(), "rb")) {
+            if (std::fread(&progress, sizeof(progress), 1, file) != 1) {
+                progress = {};
+            }
+            std::fclose(file);
+        }
+        return progress;
+    }
+
+    void write_all(int fd, const char* data, size_t size, const std::string& path)
+    {
+        while (size > 0) {
+            auto written = ::write(fd, data, size);
+            if (written < 0) {
+                throw std::runtime_error("cannot write " + path);
+            }
+            data += written;
+            size -= written;
+        }
+    }
+
+    // Replaces the progress file with a new one in a single rename
+    void write_progress(const std::string& path, const Progress& progress)
+    {
+        auto temp = path + ".tmp";
+        int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + temp);
+        }
+        write_all(fd, reinterpret_cast<const char*>(&progress), sizeof(progress), temp);
+        ::fsync(fd);
+        ::close(fd);
+        if (::rename(temp.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("cannot replace " + path);
+        }
+    }
+
+}  // namespace
+
+RecordResult eden_fractal::tools::record(const std::string& stateHistoryDir, const std::string& logPath, name contract, uint32_t lastBlock)
+{
+    auto progressPath = logPath + ".pos";
+    auto progress = read_progress(progressPath);
+
+    // Drop a block that a previous run appended without recording its progress
+    int fd = ::open(logPath.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(progress.logSize)) != 0 || ::lseek(fd, 0, SEEK_END) < 0) {
+        throw std::runtime_error("cannot open " + logPath);
+    }
+
+    MappedFile traces(stateHistoryDir + "/trace_history.log", false);
+    MappedFile deltas(stateHistoryDir + "/chain_state_history.log", false);
+
+    // Both logs hold one entry per block. A block is only recorded once both logs hold it, or when it is older than
+    // the other log's first block, so its traces and deltas are never split between two runs.
+    RecordResult result{};
+    std::vector<char> log;
+    Entry trace, delta;
+    bool haveTrace = read_entry(traces, progress.tracesPos, trace);
+    bool haveDelta = read_entry(deltas, progress.deltasPos, delta);
+    while (haveTrace && haveDelta) {
+        auto blockNum = std::min(trace.blockNum, delta.blockNum);
+        if (blockNum > lastBlock) {
+            break;
+        }
+
+        // A block's actions come before its deltas, so a pending distribution sees the balance changes it caused
+        if (trace.blockNum == blockNum) {
+            record_traces(trace, contract, log, result.entries);
+            progress.tracesPos = trace.next;
+            haveTrace = read_entry(traces, progress.tracesPos, trace);
+        }
+        if (delta.blockNum == blockNum) {
+            record_deltas(delta, contract, log, result.entries);
+            progress.deltasPos = delta.next;
+            haveDelta = read_entry(deltas, progress.deltasPos, delta);
+        }
+        result.lastBlock = blockNum;
+    }
+
+    write_all(fd, log.data(), log.size(), logPath);
+    ::fsync(fd);
+    ::close(fd);
+
+    progress.logSize += log.size();
+    write_progress(progressPath, progress);
+    return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <eosio/name.hpp>
+#include <string>
+
+namespace eden_fractal::tools {
+
+    struct RecordResult {
+        uint32_t lastBlock;  // Last block recorded, 0 when there was nothing new
+        uint64_t entries;    // Entries appended to the trace log
+    };
+
+    // Records the action traces and table deltas of `contract` into the trace log at `logPath` (see trace_log.hpp),
+    // from the logs a state-history node keeps in `stateHistoryDir` (trace_history.log and chain_state_history.log).
+    // Only blocks up to `lastBlock` are recorded, which should be irreversible, since the node rewrites the tail of
+    // its logs on a fork.
+    //
+    // Progress lives next to the trace log in `<logPath>.pos`: the size of the trace log and the read positions in
+    // both state-history logs after the last recorded block. It is replaced atomically after the trace log is synced,
+    // and a recorder that stopped halfway first truncates the trace log back to the recorded size.
+    RecordResult record(const std::string& stateHistoryDir, const std::string& logPath, eosio::name contract, uint32_t lastBlock);
+
+}  // namespace eden_fractal::tools
@@ -0,0 +1,219 @@
+#include <cstdio>
+#include <cstdlib>
+#include <eosio/asset.hpp>
+#include <eosio/ship_protocol.hpp>
+#include <eosio/to_bin.hpp>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "respect_index.hpp"
+#include "state_history.hpp"
+
+using namespace eden_fractal;
+using namespace eden_fractal::tools;
+using eosio::name;
+using namespace eosio::literals;
+
+namespace {
+
+    constexpr auto contract = "eden.fractal"_n;
+
+    struct SubmitconsArgs {
+        uint64_t groupnr;
+        std::vector<name> rankings;
+        name submitter;
+    };
+    EOSIO_REFLECT(SubmitconsArgs, groupnr, rankings, submitter);
+
+    struct LogdistribArgs {
+        uint64_t electionNr;
+        std::vector<DistributionRecord> records;
+    };
+    EOSIO_REFLECT(LogdistribArgs, electionNr, records);
+
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition) {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    template <typename T>
+    std::vector<char> bin(const T& value)
+    {
+        return eosio::convert_to_bin(value);
+    }
+
+    void write_log(const std::string& path, const std::vector<char>& log)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write(log.data(), log.size());
+    }
+
+    TableDelta balance_delta(uint32_t block, name member, int64_t amount)
+    {
+        auto row = account{.balance = eosio::asset{amount, eosio::symbol{"EDEN", 4}}};
+        return TableDelta{.blockNum = block, .code = contract, .scope = member, .table = "accounts"_n, .primaryKey = 0, .present = true, .value = bin(row)};
+    }
+
+    TableDelta election_delta(uint32_t block, uint64_t electionNr)
+    {
+        auto row = ElectionInf{.electionNr = electionNr};
+        return TableDelta{.blockNum = block, .code = contract, .scope = contract, .table = "electioninf"_n, .primaryKey = 0, .present = true, .value = bin(row)};
+    }
+
+    ActionTrace contract_action(uint32_t block, name action, std::vector<char> data)
+    {
+        return ActionTrace{.blockNum = block, .receiver = contract, .account = contract, .action = action, .data = std::move(data)};
+    }
+
+    // Appends one block's entry to a state-history log, laid out the way a state-history node writes it
+    void write_ship_entry(const std::string& path, uint32_t block, const std::vector<char>& payload)
+    {
+        auto bound = compressBound(payload.size());
+        std::vector<char> compressed(bound);
+        compress(reinterpret_cast<Bytef*>(compressed.data()), &bound, reinterpret_cast<const Bytef*>(payload.data()), payload.size());
+        compressed.resize(bound);
+
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        uint64_t position = out.tellp();
+        uint64_t magic = "ship"_n.value;
+        char blockId[32] = {char(block >> 24), char(block >> 16), char(block >> 8), char(block)};
+        uint32_t size = compressed.size();
+        uint64_t payloadSize = sizeof(size) + compressed.size();
+        out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        out.write(blockId, sizeof(blockId));
+        out.write(reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize));
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(compressed.data(), compressed.size());
+        out.write(reinterpret_cast<const char*>(&position), sizeof(position));
+    }
+
+    // A state-history node's logs with a submitcons in block 5 and a balance change in block 6, recorded and ingested
+    void test_record(const std::string& directory)
+    {
+        namespace ship = eosio::ship_protocol;
+
+        auto args = bin(SubmitconsArgs{1, {"bob"_n, "alice"_n}, "bob"_n});
+        ship::action_trace_v0 action{};
+        action.receipt.emplace();
+        action.receiver = contract;
+        action.act.account = contract;
+        action.act.name = "submitcons"_n;
+        action.act.data = eosio::input_stream(args);
+        ship::transaction_trace_v0 trace{};
+        trace.status = ship::transaction_status::executed;
+        trace.action_traces.push_back(action);
+        write_ship_entry(directory + "/trace_history.log", 5, bin(std::vector<ship::transaction_trace>{trace}));
+        write_ship_entry(directory + "/trace_history.log", 6, bin(std::vector<ship::transaction_trace>{}));
+
+        auto balance = bin(account{.balance = eosio::asset{50000, eosio::symbol{"EDEN", 4}}});
+        ship::contract_row_v0 contractRow{};
+        contractRow.code = contract;
+        contractRow.scope = "bob"_n;
+        contractRow.table = "accounts"_n;
+        contractRow.value = eosio::input_stream(balance);
+        auto rowBin = bin(ship::contract_row{contractRow});
+        ship::table_delta_v0 delta{};
+        delta.name = "contract_row";
+        delta.rows.emplace_back();
+        delta.rows.back().present = true;
+        delta.rows.back().data = eosio::input_stream(rowBin);
+        write_ship_entry(directory + "/chain_state_history.log", 5, bin(std::vector<ship::table_delta>{}));
+        write_ship_entry(directory + "/chain_state_history.log", 6, bin(std::vector<ship::table_delta>{delta}));
+
+        auto logPath = directory + "/recorded.log";
+        auto first = record(directory, logPath, contract, 5);
+        check(first.lastBlock == 5 && first.entries == 1, "only blocks up to the last irreversible one are recorded");
+        auto second = record(directory, logPath, contract, 100);
+        check(second.lastBlock == 6 && second.entries == 1, "recording resumes after the last recorded block");
+
+        auto indexDir = directory + "/recorded";
+        ::mkdir(indexDir.c_str(), 0755);
+        RespectIndex index(indexDir, contract, true);
+        check(index.ingest(logPath) == 2, "the recorded log is ingested");
+        check(index.submissions("bob"_n).size() == 1, "a recorded submission is indexed");
+        check(index.totals("bob"_n).balance == 50000, "a recorded balance change is indexed");
+    }
+
+}  // namespace
+
+int main()
+{
+    char dirTemplate[] = "/tmp/respect-index-XXXXXX";
+    std::string directory = ::mkdtemp(dirTemplate);
+    auto logPath = directory + "/trace.log";
+
+    // Election 1 predates logdistrib: amounts come from the token deltas of the submitranks block
+    std::vector<char> log;
+    append_entry(log, election_delta(10, 1));
+    auto ranks = AllRankings{{GroupRanking{{"alice"_n, "bob"_n}}, GroupRanking{{"carol"_n}}}};
+    append_entry(log, contract_action(20, "submitranks"_n, bin(ranks)));
+    append_entry(log, balance_delta(20, "alice"_n, 130000));
+    append_entry(log, balance_delta(20, "bob"_n, 80000));
+    append_entry(log, balance_delta(20, "carol"_n, 130000));
+    write_log(logPath, log);
+
+    {
+        RespectIndex index(directory, contract, true);
+        check(index.ingest(logPath) == 5, "first ingest reads every entry");
+    }
+
+    // Election 2 has a logdistrib, ingested incrementally from the end of the previous ingest
+    log.clear();
+    append_entry(log, election_delta(30, 2));
+    append_entry(log, contract_action(35, "submitcons"_n, bin(SubmitconsArgs{1, {"bob"_n, "alice"_n}, "bob"_n})));
+    append_entry(log, contract_action(40, "submitranks"_n, bin(AllRankings{{GroupRanking{{"bob"_n, "alice"_n}}}})));
+    auto records = std::vector<DistributionRecord>{{"bob"_n, 4, 130000, 20000}, {"alice"_n, 5, 80000, 12000}};
+    append_entry(log, contract_action(40, "logdistrib"_n, bin(LogdistribArgs{2, records})));
+    append_entry(log, balance_delta(40, "bob"_n, 210000));
+    append_entry(log, balance_delta(40, "alice"_n, 210000));
+    write_log(logPath, log);
+
+    {
+        RespectIndex index(directory, contract, true);
+        check(index.ingest(logPath) == 6, "second ingest only reads the new entries");
+    }
+
+    // An ingest that crashed after appending rows but before committing them left them in the columns
+    {
+        Column<uint64_t> payoutMember(directory + "/payout.member", true);
+        payoutMember.push_back("carol"_n.value);
+        Column<uint64_t> submissionMember(directory + "/submission.member", true);
+        submissionMember.push_back("bob"_n.value);
+    }
+    {
+        RespectIndex index(directory, contract, true);
+        check(index.ingest(logPath) == 0, "nothing new to ingest");
+    }
+
+    RespectIndex index(directory, contract, false);
+
+    auto aliceHistory = index.history("alice"_n);
+    check(aliceHistory.size() == 2, "alice has two payouts");
+    check(aliceHistory[0].electionNr == 1 && aliceHistory[0].rank == 4 && aliceHistory[0].eden == 130000, "election 1 amounts come from deltas");
+    check(aliceHistory[1].electionNr == 2 && aliceHistory[1].rank == 5 && aliceHistory[1].eden == 80000, "election 2 amounts come from logdistrib");
+    check(aliceHistory[1].eos == 12000, "logdistrib EOS amount is indexed");
+
+    auto leaders = index.leaderboard(10);
+    check(leaders.size() == 3, "leaderboard has every member");
+    check(leaders[0].member == "alice"_n.value || leaders[0].member == "bob"_n.value, "top of the leaderboard");
+    check(leaders[0].eden == 210000 && leaders[2].member == "carol"_n.value, "leaderboard is ordered by EDEN paid out");
+
+    auto bob = index.totals("bob"_n);
+    check(bob.balance == 210000 && bob.elections == 2, "bob totals");
+
+    auto bobSubmissions = index.submissions("bob"_n);
+    check(bobSubmissions.size() == 1 && bobSubmissions[0].electionNr == 2 && bobSubmissions[0].groupNr == 1, "submitcons is indexed once");
+    check(index.history("carol"_n).size() == 1, "rows of an uncommitted ingest are dropped");
+
+    test_record(directory);
+
+    std::system(("rm -rf " + directory).c_str());
+    return failures == 0 ? 0 : 1;
+}
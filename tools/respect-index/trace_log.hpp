@@ -0,0 +1,68 @@
+#pragma once
+
+#include <eosio/from_bin.hpp>
+#include <eosio/name.hpp>
+#include <eosio/reflection.hpp>
+#include <eosio/stream.hpp>
+#include <eosio/to_bin.hpp>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+namespace eden_fractal::tools {
+
+    // A recorded trace log is a sequence of binary-serialized LogEntry values in block order. It holds the action
+    // traces and table deltas of the contract account, as recorded from a state-history node by `record`
+    // (state_history.hpp).
+    struct ActionTrace {
+        uint32_t blockNum;
+        eosio::name receiver;
+        eosio::name account;
+        eosio::name action;
+        std::vector<char> data;
+    };
+    EOSIO_REFLECT(ActionTrace, blockNum, receiver, account, action, data);
+
+    struct TableDelta {
+        uint32_t blockNum;
+        eosio::name code;
+        eosio::name scope;
+        eosio::name table;
+        uint64_t primaryKey;
+        bool present;  // False when the row was removed
+        std::vector<char> value;
+    };
+    EOSIO_REFLECT(TableDelta, blockNum, code, scope, table, primaryKey, present, value);
+
+    using LogEntry = std::variant<ActionTrace, TableDelta>;
+
+    // Streams the entries of a log file without copying it into memory, starting at byte `offset`
+    class TraceLogReader {
+       public:
+        TraceLogReader(const std::string& path, uint64_t offset) : file(path, false), stream(file.data() + offset, file.data() + file.size()) {}
+
+        uint64_t offset() const { return stream.pos - file.data(); }
+
+        bool next(LogEntry& entry)
+        {
+            if (stream.remaining() == 0) {
+                return false;
+            }
+            entry = eosio::from_bin<LogEntry>(stream);
+            return true;
+        }
+
+       private:
+        MappedFile file;
+        eosio::input_stream stream;
+    };
+
+    inline void append_entry(std::vector<char>& log, const LogEntry& entry)
+    {
+        auto bin = eosio::convert_to_bin(entry);
+        log.insert(log.end(), bin.begin(), bin.end());
+    }
+
+}  // namespace eden_fractal::tools
@@ -0,0 +1,172 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "reward_sim.hpp"
+
+using namespace eden_fractal::tools;
+
+namespace {
+
+    int usage()
+    {
+        std::fprintf(stderr,
+                     "usage: reward-sim [options] <rankings.json>...\n"
+                     "  Each rankings file is one election, in the format of first_submission.json, in election order.\n"
+                     "  --fib <from>[:<to>]                fib offsets to sweep (default 5)\n"
+                     "  --eos <from>[:<to>[:<step>]]       EOS reward amounts to sweep (default 100)\n"
+                     "  --curve <name>|<name>=<w1,w2,...>  EOS curve, repeatable: phi, linear, flat or explicit weights (default phi)\n"
+                     "  --max-group <n>                    largest group size for named curves (default 6)\n"
+                     "  --min-group <n>                    smallest group size (default 5)\n"
+                     "  --supply <eden>                    EDEN supply before the first election (default 0)\n"
+                     "  --threads <n>                      worker threads (default: one per core)\n");
+        return 1;
+    }
+
+    // Amount in the smallest unit of a 4-decimal token, from "100" or "100.5"
+    int64_t parse_amount(const std::string& text)
+    {
+        return std::llround(std::strtod(text.c_str(), nullptr) * 10000);
+    }
+
+    std::string format_amount(int64_t amount)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%s%lld.%04lld", amount < 0 ? "-" : "", std::llabs(amount) / 10000, std::llabs(amount) % 10000);
+        return buffer;
+    }
+
+    std::vector<std::string> split(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        for (auto end = text.find(separator); end != std::string::npos; end = text.find(separator, start)) {
+            parts.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        parts.push_back(text.substr(start));
+        return parts;
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> fibRange{"5"};
+    std::vector<std::string> eosRange{"100"};
+    std::vector<std::string> curveArgs;
+    uint8_t maxGroup = 6;
+    uint8_t minGroup = 5;
+    int64_t supply = 0;
+    unsigned threads = 0;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0 && i + 1 >= argc) {
+            return usage();
+        }
+        if (arg == "--fib") {
+            fibRange = split(argv[++i], ':');
+        }
+        else if (arg == "--eos") {
+            eosRange = split(argv[++i], ':');
+        }
+        else if (arg == "--curve") {
+            curveArgs.push_back(argv[++i]);
+        }
+        else if (arg == "--max-group") {
+            maxGroup = std::atoi(argv[++i]);
+        }
+        else if (arg == "--min-group") {
+            minGroup = std::atoi(argv[++i]);
+        }
+        else if (arg == "--supply") {
+            supply = parse_amount(argv[++i]);
+        }
+        else if (arg == "--threads") {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            return usage();
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        return usage();
+    }
+    if (curveArgs.empty()) {
+        curveArgs.push_back("phi");
+    }
+
+    try {
+        std::vector<eden_fractal::AllRankings> history;
+        for (const auto& file : files) {
+            history.push_back(load_rankings(file));
+        }
+
+        std::vector<std::pair<std::string, std::vector<double>>> curves;
+        for (const auto& arg : curveArgs) {
+            auto eq = arg.find('=');
+            if (eq == std::string::npos) {
+                curves.emplace_back(arg, named_curve(arg, maxGroup));
+                continue;
+            }
+            std::vector<double> weights;
+            for (const auto& w : split(arg.substr(eq + 1), ',')) {
+                weights.push_back(std::strtod(w.c_str(), nullptr));
+            }
+            curves.emplace_back(arg.substr(0, eq), weights);
+        }
+
+        int fibFrom = std::atoi(fibRange[0].c_str());
+        int fibTo = fibRange.size() > 1 ? std::atoi(fibRange[1].c_str()) : fibFrom;
+        int64_t eosFrom = parse_amount(eosRange[0]);
+        int64_t eosTo = eosRange.size() > 1 ? parse_amount(eosRange[1]) : eosFrom;
+        int64_t eosStep = eosRange.size() > 2 ? parse_amount(eosRange[2]) : 10000;
+        if (eosStep <= 0) {
+            return usage();
+        }
+
+        std::vector<Policy> policies;
+        for (const auto& [curveName, curve] : curves) {
+            for (int fib = fibFrom; fib <= fibTo; ++fib) {
+                for (auto eos = eosFrom; eos <= eosTo; eos += eosStep) {
+                    policies.push_back(Policy{.fibOffset = static_cast<uint8_t>(fib),
+                                              .eosRewardAmt = eos,
+                                              .curveName = curveName,
+                                              .curve = curve,
+                                              .minGroupSize = minGroup});
+                }
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto reports = sweep(history, policies, supply, threads);
+        auto elapsed = seconds_since(start);
+
+        std::printf("fib_offset,eos_reward,curve,eden_minted,eos_paid,last_inflation,members,gini,top10_share,p50,p90,max,error\n");
+        for (const auto& r : reports) {
+            std::printf("%u,%s,%s,%s,%s,%.6f,%u,%.4f,%.4f,%s,%s,%s,%s\n", r.policy.fibOffset, format_amount(r.policy.eosRewardAmt).c_str(), r.policy.curveName.c_str(),
+                        format_amount(r.edenMinted).c_str(), format_amount(r.eosPaid).c_str(), r.lastInflation, r.members, r.gini, r.top10Share,
+                        format_amount(r.p50).c_str(), format_amount(r.p90).c_str(), format_amount(r.max).c_str(), r.error ? r.error->c_str() : "");
+        }
+        std::fprintf(stderr, "%zu policies over %zu elections in %.2f s\n", policies.size(), history.size(), elapsed);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
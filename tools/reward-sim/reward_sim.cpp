@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <atomic>
+#include <eosio/from_json.hpp>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "reward_sim.hpp"
+
+namespace eden_fractal::tools {
+
+    namespace {
+
+        constexpr uint8_t edenPrecision = 4;
+
+        double gini(const std::vector<int64_t>& sorted, double total)
+        {
+            if (sorted.empty() || total == 0) {
+                return 0;
+            }
+            double weighted = 0;
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                weighted += (i + 1) * static_cast<double>(sorted[i]);
+            }
+            double n = sorted.size();
+            return 2 * weighted / (n * total) - (n + 1) / n;
+        }
+
+        int64_t percentile(const std::vector<int64_t>& sorted, double p)
+        {
+            if (sorted.empty()) {
+                return 0;
+            }
+            return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+        }
+
+    }  // namespace
+
+    RewardConfig config_of(const Policy& policy)
+    {
+        return RewardConfig{.eos_reward_amt = policy.eosRewardAmt,
+                            .fib_offset = policy.fibOffset,
+                            .min_groups = policy.minGroups,
+                            .min_group_size = policy.minGroupSize,
+                            .max_group_size = static_cast<uint8_t>(policy.curve.size()),
+                            .eos_curve = policy.curve};
+    }
+
+    std::vector<DistributionRecord> distribute(const AllRankings& ranks, const RewardTables& tables, std::string& error)
+    {
+        return rewards::distribution(ranks, tables, error).records;
+    }
+
+    PolicyReport simulate(const std::vector<AllRankings>& history, const Policy& policy, int64_t initialSupply)
+    {
+        PolicyReport report{.policy = policy};
+        auto config = config_of(policy);
+        auto configError = rewards::config_error(config);
+        if (!configError.empty()) {
+            report.error = std::string(configError);
+            return report;
+        }
+        auto tables = rewards::make_tables(config, edenPrecision);
+
+        std::map<uint64_t, int64_t> holdings;
+        int64_t supply = initialSupply;
+        for (size_t e = 0; e < history.size(); ++e) {
+            std::string error;
+            auto records = distribute(history[e], tables, error);
+            if (!error.empty()) {
+                report.error = "election " + std::to_string(e + 1) + ": " + error;
+                return report;
+            }
+
+            int64_t minted = 0;
+            for (const auto& record : records) {
+                holdings[record.member.value] += record.eden;
+                minted += record.eden;
+                report.eosPaid += record.eos;
+            }
+            if (e + 1 == history.size() && supply > 0) {
+                report.lastInflation = static_cast<double>(minted) / supply;
+            }
+            supply += minted;
+            report.edenMinted += minted;
+        }
+
+        std::vector<int64_t> totals;
+        for (const auto& [member, eden] : holdings) {
+            totals.push_back(eden);
+        }
+        std::sort(totals.begin(), totals.end());
+
+        double total = report.edenMinted;
+        size_t topCount = (totals.size() + 9) / 10;
+        int64_t top = 0;
+        for (size_t i = totals.size() - topCount; i < totals.size(); ++i) {
+            top += totals[i];
+        }
+
+        report.members = totals.size();
+        report.gini = gini(totals, total);
+        report.top10Share = total > 0 ? top / total : 0;
+        report.p50 = percentile(totals, 0.5);
+        report.p90 = percentile(totals, 0.9);
+        report.max = totals.empty() ? 0 : totals.back();
+        return report;
+    }
+
+    std::vector<PolicyReport> sweep(const std::vector<AllRankings>& history, const std::vector<Policy>& policies, int64_t initialSupply, unsigned threads)
+    {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Policies are independent, so workers just take the next one until none are left
+        std::vector<PolicyReport> reports(policies.size());
+        std::atomic<size_t> next{0};
+        auto work = [&]() {
+            for (auto i = next.fetch_add(1); i < policies.size(); i = next.fetch_add(1)) {
+                reports[i] = simulate(history, policies[i], initialSupply);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return reports;
+    }
+
+    AllRankings load_rankings(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        auto json = buffer.str();
+
+        AllRankings ranks;
+        eosio::json_token_stream stream(json.data());
+        eosio::from_json(ranks, stream);
+        return ranks;
+    }
+
+    std::vector<double> named_curve(const std::string& name, uint8_t maxGroupSize)
+    {
+        if (name == "phi") {
+            auto curve = upgrade_row(RewardConfigV0{}).eos_curve;
+            if (maxGroupSize > curve.size()) {
+                throw std::runtime_error("the phi curve has " + std::to_string(curve.size()) + " ranks");
+            }
+            return std::vector<double>(curve.end() - maxGroupSize, curve.end());
+        }
+        std::vector<double> curve(maxGroupSize, 1);
+        if (name == "linear") {
+            for (size_t i = 0; i < curve.size(); ++i) {
+                curve[i] = i + 1;
+            }
+        }
+        else if (name != "flat") {
+            throw std::runtime_error("unknown curve " + name);
+        }
+        return curve;
+    }
+
+}  // namespace eden_fractal::tools
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "rewards.hpp"
+#include "schemas.hpp"
+
+namespace eden_fractal::tools {
+
+    // One reward policy to simulate: the settings of fiboffset, eosrewardamt and the setrewardcfg curve
+    struct Policy {
+        uint8_t fibOffset;
+        int64_t eosRewardAmt;  // In the smallest unit of EOS
+        std::string curveName;
+        std::vector<double> curve;  // EOS weight per rank index, lowest rank first
+        uint8_t minGroups = 2;
+        uint8_t minGroupSize = 5;
+    };
+
+    struct PolicyReport {
+        Policy policy;
+        std::optional<std::string> error;  // Set when submitranks would fail for one of the elections
+
+        int64_t edenMinted;    // Over all elections, in the smallest unit of EDEN
+        int64_t eosPaid;       // Over all elections, in the smallest unit of EOS
+        double lastInflation;  // EDEN minted by the last election, relative to the supply before it
+
+        // Over the members' total EDEN at the end of the history
+        uint32_t members;
+        double gini;
+        double top10Share;  // Share of all EDEN held by the top 10% of members
+        int64_t p50;
+        int64_t p90;
+        int64_t max;
+    };
+
+    // The distribution of one submitranks call, computed with the contract's reward code (see rewards.hpp)
+    // so every amount is identical to what the contract pays. Fails like submitranks would, with its error message.
+    std::vector<DistributionRecord> distribute(const AllRankings& ranks, const RewardTables& tables, std::string& error);
+
+    // The config setrewardcfg, fiboffset and eosrewardamt would set for `policy`
+    RewardConfig config_of(const Policy& policy);
+
+    // Simulates `history`, one AllRankings per election in order, starting from `initialSupply` EDEN
+    PolicyReport simulate(const std::vector<AllRankings>& history, const Policy& policy, int64_t initialSupply);
+
+    // Simulates every policy, spread over `threads` threads (0: one per core). Reports are in the order of `policies`.
+    std::vector<PolicyReport> sweep(const std::vector<AllRankings>& history, const std::vector<Policy>& policies, int64_t initialSupply, unsigned threads);
+
+    // Reads a file in the format of first_submission.json: the JSON form of the submitranks AllRankings argument
+    AllRankings load_rankings(const std::string& path);
+
+    // Curves by name: "phi" (the original powers of phi), "linear" (1, 2, ...) and "flat" (all 1)
+    std::vector<double> named_curve(const std::string& name, uint8_t maxGroupSize);
+
+}  // namespace eden_fractal::tools
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <string>
+
+#include "reward_sim.hpp"
+
+using namespace eden_fractal;
+using namespace eden_fractal::tools;
+using namespace eosio::literals;
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition) {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    Policy default_policy()
+    {
+        return Policy{.fibOffset = 5, .eosRewardAmt = 1000000, .curveName = "phi", .curve = named_curve("phi", 6)};
+    }
+
+    AllRankings two_groups()
+    {
+        return AllRankings{{GroupRanking{{"james"_n, "dan"_n, "alice"_n, "bob"_n, "charlie"_n, "igor"_n}},
+                            GroupRanking{{"david"_n, "elaine"_n, "frank"_n, "gary"_n, "harry"_n, "jenny"_n}}}};
+    }
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: test-reward-sim <first_submission.json>\n");
+        return 1;
+    }
+
+    // Amounts the contract pays for the same ranking, see the "Reward distribution" scenario of the contract tests
+    {
+        std::string error;
+        auto tables = rewards::make_tables(config_of(default_policy()), 4);
+        auto records = distribute(two_groups(), tables, error);
+        check(error.empty() && records.size() == 12, "two groups of 6 are distributed");
+        check(records[0].member == "james"_n && records[0].rank == 0, "first record is rank index 0 of the first group");
+        check(records[5].rank == 5, "last member of a full group has the top rank index");
+        check(records[0].eden == 50000, "rank 1 gets 5 EDEN at fib offset 5");
+        check(records[0].eos == 18238, "rank 1 gets 1.8238 EOS of 100 EOS over 2 groups");
+        check(records[5].eden == 550000, "rank 6 gets 55 EDEN");
+    }
+
+    // Submitranks failures are reported, not thrown
+    {
+        auto ranks = two_groups();
+        ranks.allRankings[1].ranking.resize(4);
+        auto report = simulate({ranks}, default_policy(), 0);
+        check(report.error && report.error->find(errors::group_too_small) != std::string::npos, "small groups fail like submitranks");
+
+        auto underfunded = default_policy();
+        underfunded.eosRewardAmt = 1;
+        auto tiny = simulate({two_groups()}, underfunded, 0);
+        check(tiny.error && tiny.error->find(errors::eosRewardTooSmall) != std::string::npos, "EOS too small to pay fails like submitranks");
+
+        auto policy = default_policy();
+        policy.fibOffset = 80;
+        check(simulate({two_groups()}, policy, 0).error.has_value(), "configs setrewardcfg would reject fail");
+    }
+
+    // A sweep over the recorded first submission gives the same reports on any number of threads
+    {
+        std::vector<AllRankings> history{load_rankings(argv[1]), load_rankings(argv[1])};
+        // The second election ranks the same members, so both elections pay the same
+        history[1].allRankings = history[0].allRankings;
+
+        std::vector<Policy> policies;
+        for (uint8_t fib = 3; fib <= 8; ++fib) {
+            for (int64_t eos = 100000; eos <= 2000000; eos += 100000) {
+                auto policy = default_policy();
+                policy.fibOffset = fib;
+                policy.eosRewardAmt = eos;
+                policies.push_back(policy);
+            }
+        }
+
+        auto parallel = sweep(history, policies, 1000000, 4);
+        auto sequential = sweep(history, policies, 1000000, 1);
+        bool same = parallel.size() == policies.size();
+        for (size_t i = 0; same && i < policies.size(); ++i) {
+            same = parallel[i].edenMinted == sequential[i].edenMinted && parallel[i].eosPaid == sequential[i].eosPaid && parallel[i].gini == sequential[i].gini;
+        }
+        check(same, "parallel sweep matches the sequential one");
+
+        const auto& base = parallel[2 * 20];  // fib offset 5, 10 EOS
+        check(!base.error, "recorded history distributes");
+        check(base.edenMinted > 0 && base.members > 0, "EDEN is minted to the ranked members");
+        check(base.gini >= 0 && base.gini < 1, "gini is in [0, 1)");
+        check(base.lastInflation > 0, "inflation of the last election is reported");
+    }
+
+    return failures == 0 ? 0 : 1;
+}